@@ -2,14 +2,16 @@
 #define NAO_FRAMEWORK_COMM_BLACKBOARD_HEADER_FILE
 
 #include <NaoFramework/Comm/Types.hpp>
+#include <NaoFramework/Comm/Slot.hpp>
+#include <NaoFramework/Comm/Recorder.hpp>
 #include <NaoFramework/Log/Loggable.hpp>
 
 #include <unordered_map>
+#include <vector>
+#include <memory>
 #include <functional>
 #include <typeindex>
-
-#include <boost/any.hpp>
-#include <boost/thread.hpp>
+#include <atomic>
 
 namespace NaoFramework {
     namespace Comm {
@@ -20,6 +22,10 @@ namespace NaoFramework {
          * communication from a thread to many threads. The object allows registration of data
          * requests and data provisions of any size and type. 
          *                                                                                         
+         * Data is stored in typed slots which are created during registration, so accessing data
+         * never involves key lookups, allocations or run-time type checks. For this reason, all
+         * types used with a Blackboard must be default constructible and copy assignable.
+         *
          * Blackboard is able to perform run-time type checking. Pre-emptive checks are performed
          * for single threaded requests, so that invalid data requests/provisions are treated
          * as errors. It is important to notice that such errors do NOT throw, but instead are
@@ -58,6 +64,8 @@ namespace NaoFramework {
          * an initial value to be setup on the key, so that at least a value is always available to be 
          * requested. In addition, to keep things simple and consistent, a single global provider is
          * allowed on a given key, with no other providers, be it local or global.
+         * Globally provided data is stored in a TripleBuffer, so that the provider never has
+         * to wait for readers in other threads, and readers always get the latest complete value.
          * The request is accepted unless:
          *
          * - A local provider of data is already registered on the same key.
@@ -123,6 +131,23 @@ namespace NaoFramework {
                 template <class T>
                 RequireFunction<T> registerRequire          (const std::string & key, RegistrationError * e = nullptr);
 
+                /**
+                 * @brief This function registers a data request of the given type and key, without copies.
+                 *
+                 * This function works as registerRequire(), but the returned function gives
+                 * a ReadView on the data instead of a copy. This is meant for large data, like
+                 * images, where copying each cycle is expensive. Small data should use
+                 * registerRequire() instead, as views may hold locks.
+                 *
+                 * @tparam T The type of the data request.
+                 * @param key The key that should hold the data.
+                 * @param e A pointer to report eventual errors to the caller.
+                 *
+                 * @return A function to view data if successful, an empty function otherwise.
+                 */
+                template <class T>
+                ViewFunction<T>    registerRequireView      (const std::string & key, RegistrationError * e = nullptr);
+
                 /**
                  * @brief This function registers a local data provision with the given type and key.
                  *
@@ -153,6 +178,23 @@ namespace NaoFramework {
                 template <class T>
                 RequireFunction<T> registerGlobalRequire    (const std::string & key, RegistrationError * e = nullptr);
 
+                /**
+                 * @brief This function register a global data request with the given type and key, without copies.
+                 *
+                 * This function works as registerGlobalRequire(), but the returned function
+                 * gives a ReadView on the data instead of a copy.
+                 *
+                 * \sa registerRequireView()
+                 *
+                 * @tparam T The type of the data request.
+                 * @param key The key that should hold the data.
+                 * @param e A pointer to report eventual errors to the caller.
+                 *
+                 * @return A function to view data if successful, an empty function otherwise.
+                 */
+                template <class T>
+                ViewFunction<T>    registerGlobalRequireView(const std::string & key, RegistrationError * e = nullptr);
+
                 /**
                  * @brief A function to register a global provision of data with the given type and key.
                  *
@@ -176,9 +218,81 @@ namespace NaoFramework {
                  * Since the initialization of global requires and global provides is not linear, this
                  * gives a way to discern whether the current configuration is OK under that side.
                  *
-                 * @return 
+                 * Once the configuration is known to be valid, keys that are only provided locally
+                 * are known to be accessed by a single thread, and their accessors stop locking.
+                 *
+                 * @return True if all data requests are provided for, false otherwise.
+                 */
+                bool validateGlobals();
+
+                /**
+                 * @brief This function checks whether all data requests have been provided for, without changing anything.
+                 *
+                 * Unlike validateGlobals(), this can be called while the wave of the Blackboard is running.
+                 *
+                 * @return True if all data requests are provided for, false otherwise.
+                 */
+                bool areGlobalsProvided() const;
+
+                /**
+                 * @brief This function allows a globally provided key to be globally provided again.
+                 *
+                 * This is used when the module providing the key is reloaded: until the new module
+                 * provides the key again, the key counts as requested. The slot of the key is kept,
+                 * so that other modules keep their accessors, and keep reading the last data.
+                 *
+                 * @param key The key to release.
+                 *
+                 * @return True if the key was globally provided, false otherwise.
+                 */
+                bool releaseGlobalProvide(const std::string & key);
+
+                /**
+                 * @brief This function records every write to a key.
+                 *
+                 * Recording starts with the next write, and can be started at any time, but
+                 * only on keys whose type has a Serializer, and which are not being recorded
+                 * already: stopRecording() must be called first.
+                 *
+                 * @param key The key to record.
+                 * @param recorder The Recorder to write to.
+                 * @param cycles The cycle counter of the wave of this Blackboard, or nullptr.
+                 *
+                 * @return True if the key is being recorded, false otherwise.
+                 */
+                bool record(const std::string & key, Recorder & recorder, const std::atomic<unsigned long> * cycles);
+
+                /**
+                 * @brief This function stops recording all keys of this Blackboard.
+                 */
+                void stopRecording();
+
+                /**
+                 * @brief This function registers a replayer as the global provider of a key.
+                 *
+                 * The key must have been required, with the recorded type, and must not be
+                 * provided by anyone else. Its slot is then buffered as for any global provide,
+                 * so that recorded data can be written into it while other threads read it.
+                 *
+                 * @param key The key to replay.
+                 * @param type The name of the recorded type, as given by typeid.
+                 *
+                 * @return The slot to write recorded data into, or nullptr if the key cannot be replayed.
+                 */
+                SlotBase * registerReplay(const std::string & key, const std::string & type);
+
+                /**
+                 * @brief This function returns a Trigger notified whenever the given key is provided.
+                 *
+                 * This can be used by other threads to wait for new data on the key.
+                 * Triggers should be requested once all registrations are done, as a
+                 * later local provide with a different type moves the key to a new slot.
+                 *
+                 * @param key The key to watch.
+                 *
+                 * @return The Trigger for the key, or nullptr if the key is not registered.
                  */
-                bool validateGlobals() const;
+                Trigger * getTrigger(const std::string & key);
 
                 /**
                  * @brief This function returns the name of the Blackboard.
@@ -189,9 +303,6 @@ namespace NaoFramework {
 
             private:
                 std::string name_;
-                using Lock = boost::shared_mutex;
-                using WriteLock = boost::unique_lock<Lock>;
-                using ReadLock  = boost::shared_lock<Lock>;
 
                 enum class TypeState {
                     Requested,          // A requested status can only be fixed by a global provider
@@ -199,13 +310,51 @@ namespace NaoFramework {
                     GlobalProvided      // Only a single global provider is allowed for a particular key.
                 };
 
+                /**
+                 * @brief This function returns the slot for the given key, creating it if needed.
+                 *
+                 * If the key currently holds a slot of a different type, a new slot replaces
+                 * it for all future registrations. This can only happen when a local provide
+                 * changes the type of a key, and previously created accessors keep working on
+                 * the old slot, as required by the sequential ordering of local registrations.
+                 *
+                 * @tparam T The type of the data of the key.
+                 * @param key The key of the slot.
+                 *
+                 * @return The slot holding the data for the key.
+                 */
                 template<class T>
-                RequireFunction<T> makeRequireFunction(const std::string & key);
+                Slot<T> & getSlot(const std::string & key);
+
+                /**
+                 * @brief This function checks a local data request, and returns the slot to serve it.
+                 *
+                 * @tparam T The type of the data request.
+                 * @param key The key that should hold the data.
+                 * @param e A pointer to report eventual errors to the caller.
+                 *
+                 * @return The slot for the key if successful, nullptr otherwise.
+                 */
                 template<class T>
-                ProvideFunction<T> makeProvideFunction(const std::string & key);
+                Slot<T> * requireSlot(const std::string & key, RegistrationError * e);
 
-                // This is the map that is actually used during a run of the framework.
-                std::unordered_map<std::string, std::pair<boost::shared_mutex, boost::any>> board_;
+                /**
+                 * @brief This function checks a global data request, and returns the slot to serve it.
+                 *
+                 * @tparam T The type of the data request.
+                 * @param key The key that should hold the data.
+                 * @param e A pointer to report eventual errors to the caller.
+                 *
+                 * @return The slot for the key if successful, nullptr otherwise.
+                 */
+                template<class T>
+                Slot<T> * globalRequireSlot(const std::string & key, RegistrationError * e);
+
+
+                // This is the storage that is actually used during a run of the framework.
+                std::vector<std::unique_ptr<SlotBase>> slots_;
+                // Maps keys to their slots. This is only used during registration.
+                std::unordered_map<std::string, SlotBase*> board_;
                 // First type index is used generally. We use two in case we request a type, and then 
                 // we provide another. the first type then needs to wait for a global provide, or 
                 // we cannot validate the arrangement.
@@ -214,32 +363,50 @@ namespace NaoFramework {
 
         template <class T>
         RequireFunction<T> Blackboard::registerRequire(const std::string & key, RegistrationError * e) {
-            auto it = board_.find(key);
+            auto slot = requireSlot<T>(key, e);
+            if ( !slot ) return RequireFunction<T>();
+
+            // Creating accessor function
+            return RequireFunction<T>(*slot);
+        }
+
+        template <class T>
+        ViewFunction<T> Blackboard::registerRequireView(const std::string & key, RegistrationError * e) {
+            auto slot = requireSlot<T>(key, e);
+            if ( !slot ) return ViewFunction<T>();
+
+            return ViewFunction<T>(*slot);
+        }
+
+        template <class T>
+        Slot<T> * Blackboard::requireSlot(const std::string & key, RegistrationError * e) {
+            auto it = typeCheck_.find(key);
             std::type_index type(typeid(T));
 
-            if ( it != std::end(board_) ) {
-                auto & tuple = typeCheck_.at(key);
+            if ( it != std::end(typeCheck_) ) {
+                auto & tuple = it->second;
                 // Check that whatever is in there is our type.
                 if ( type != std::get<1>(tuple) ) {
                     if ( e ) *e = RegistrationError::WrongType;
-                    return RequireFunction<T>();
+                    return nullptr;
                 } // State remains as it was before. Requested -> Requested, Provided -> Provided, GlobalProvided -> GlobalProvided
             }
             else typeCheck_.emplace(key, std::make_pair(TypeState::Requested, type));
 
-            // Creating accessor function
-            return makeRequireFunction<T>(key);
+            // The slot is created now even if nobody provides it yet, so that
+            // accessors never need to look it up again.
+            return &getSlot<T>(key);
         }
 
         template <class T>
         ProvideFunction<T> Blackboard::registerProvide(const std::string & key, RegistrationError * e) {
             log("Providing " + key);
-            auto it = board_.find(key);
+            auto it = typeCheck_.find(key);
             std::type_index type(typeid(T));
 
-            if ( it != std::end(board_) ) {
+            if ( it != std::end(typeCheck_) ) {
                 log("    Already registered.");
-                auto & pair = typeCheck_.at(key);
+                auto & pair = it->second;
                 // If it was requested, then the only way this is going to work is that the key gets GlobalProvided.
                 // Since global providers are unique, we can't provide here.
                 if ( std::get<0>(pair) == TypeState::Requested ) {
@@ -262,36 +429,51 @@ namespace NaoFramework {
             // Setting up board key. We have to do this because record creation is not
             // protected by the mutexes, only the modifications are!
             log("Setting " + key);
-            board_[key];
+            auto & slot = getSlot<T>(key);
 
             // Creating accessor function.
             log("Building provider function.");
-            return makeProvideFunction<T>(key);
+            return ProvideFunction<T>(slot);
         }
 
         template <class T>
         RequireFunction<T> Blackboard::registerGlobalRequire(const std::string & key, RegistrationError * e) {
+            auto slot = globalRequireSlot<T>(key, e);
+            if ( !slot ) return RequireFunction<T>();
+
+            return RequireFunction<T>(*slot);
+        }
+
+        template <class T>
+        ViewFunction<T> Blackboard::registerGlobalRequireView(const std::string & key, RegistrationError * e) {
+            auto slot = globalRequireSlot<T>(key, e);
+            if ( !slot ) return ViewFunction<T>();
+
+            return ViewFunction<T>(*slot);
+        }
+
+        template <class T>
+        Slot<T> * Blackboard::globalRequireSlot(const std::string & key, RegistrationError * e) {
             // Here we have the additional constraint that the key cannot be Provided.
             // Otherwise we cannot guarantee that whatever sheduling happens between threads will 
             // make sure that this require always succeeds.
-            auto it = board_.find(key);
-            std::type_index type(typeid(T));
+            auto it = typeCheck_.find(key);
 
-            if ( it != std::end(board_) && std::get<0>(typeCheck_.at(key)) == TypeState::Provided ) {
+            if ( it != std::end(typeCheck_) && std::get<0>(it->second) == TypeState::Provided ) {
                 if ( e ) *e = RegistrationError::LocallyProvided;
-                return RequireFunction<T>();
+                return nullptr;
             }
             // Applies all local require constraints
-            return registerRequire<T>(key);
+            return requireSlot<T>(key, e);
         }
 
         template <class T>
         ProvideFunction<T> Blackboard::registerGlobalProvide(const std::string & key, const T & value, RegistrationError * e) {
-            auto it = board_.find(key);
+            auto it = typeCheck_.find(key);
             std::type_index type(typeid(T));
 
-            if ( it != std::end(board_) ) {
-                auto & tuple = typeCheck_.at(key);
+            if ( it != std::end(typeCheck_) ) {
+                auto & tuple = it->second;
                 auto & currentState = std::get<0>(tuple);
 
                 if ( currentState == TypeState::Provided ) {
@@ -312,31 +494,24 @@ namespace NaoFramework {
 
             // Setting up board key. We have to do this because record creation is not
             // protected by the mutexes, only the modifications are!
-            board_[key].second = value;
+            auto & slot = getSlot<T>(key);
+            slot.makeGlobal(value);
 
-            return makeProvideFunction<T>(key);
+            return ProvideFunction<T>(slot);
         }
 
         template<class T>
-        RequireFunction<T> Blackboard::makeRequireFunction(const std::string & key) {
-            RequireFunction<T> requirer = [this, key](){
-                auto & pair = board_.at(key);
-                ReadLock lock(pair.first);
-
-                return boost::any_cast<T>(pair.second);
-            };
-            return requirer;
-        }
+        Slot<T> & Blackboard::getSlot(const std::string & key) {
+            auto it = board_.find(key);
+            // Types are checked once here, so accessors can use the slot directly.
+            if ( it != std::end(board_) && it->second->getType() == std::type_index(typeid(T)) )
+                return *static_cast<Slot<T>*>(it->second);
 
-        template<class T>
-        ProvideFunction<T> Blackboard::makeProvideFunction(const std::string & key) {
-            ProvideFunction<T> provider = [this, key](const T& input){
-                auto & pair = board_[key];
-                WriteLock lock(pair.first);
-
-                pair.second = input;
-            };
-            return provider;
+            auto slot = new Slot<T>();
+            slots_.emplace_back(slot);
+            board_[key] = slot;
+
+            return *slot;
         }
     }
 }
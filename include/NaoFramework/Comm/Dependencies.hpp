@@ -0,0 +1,42 @@
+#ifndef NAO_FRAMEWORK_COMM_DEPENDENCIES_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_DEPENDENCIES_HEADER_FILE
+
+#include <string>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This struct lists the keys a module registered on its local Blackboard.
+         *
+         * This is used to find out which modules of a BrainWave can run concurrently:
+         * two modules which neither provide anything the other requires, nor provide
+         * the same keys, do not depend on each other.
+         */
+        struct Dependencies {
+            std::vector<std::string> required;
+            std::vector<std::string> provided;
+
+            /**
+             * @brief This function checks whether two modules need to run in order.
+             *
+             * @param other The dependencies of the other module.
+             *
+             * @return True if the modules share keys that are provided by any of them, false otherwise.
+             */
+            bool conflictsWith(const Dependencies & other) const {
+                auto intersect = [](const std::vector<std::string> & a, const std::vector<std::string> & b) {
+                    for ( auto & x : a )
+                        for ( auto & y : b )
+                            if ( x == y ) return true;
+                    return false;
+                };
+                return intersect(required, other.provided) ||
+                       intersect(provided, other.required) ||
+                       intersect(provided, other.provided);
+            }
+        };
+    }
+}
+
+#endif
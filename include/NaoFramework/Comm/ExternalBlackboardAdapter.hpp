@@ -3,8 +3,10 @@
 
 #include <NaoFramework/Comm/Types.hpp>
 #include <NaoFramework/Comm/Blackboard.hpp>
+#include <NaoFramework/Comm/Dependencies.hpp>
 
 #include <functional>
+#include <utility>
 
 namespace NaoFramework {
     namespace Comm {
@@ -21,16 +23,30 @@ namespace NaoFramework {
                  * @brief Basic constructor.
                  *
                  * @param b A reference to a Blackboard instance.
+                 * @param d Where to record successful registrations, if needed.
                  */
-                ExternalBlackboardAdapter(Blackboard & b) : blackboard_(b) {}
+                ExternalBlackboardAdapter(Blackboard & b, Dependencies * d = nullptr) : blackboard_(b), dependencies_(d) {}
 
                 /// \sa Blackboard::registerGlobalRequire()
                 template <class T>
                 RequireFunction<T> registerGlobalRequire    (const std::string & s, RegistrationError * e = nullptr) {
-                    return blackboard_.registerGlobalRequire<T>(s,e);
+                    return recordRequire(s, blackboard_.registerGlobalRequire<T>(s,e));
+                }
+
+                /// \sa Blackboard::registerGlobalRequireView()
+                template <class T>
+                ViewFunction<T>    registerGlobalRequireView(const std::string & s, RegistrationError * e = nullptr) {
+                    return recordRequire(s, blackboard_.registerGlobalRequireView<T>(s,e));
                 }
             private:
                 Blackboard & blackboard_;
+                Dependencies * dependencies_;
+
+                template <class F>
+                F recordRequire(const std::string & s, F && f) {
+                    if ( f && dependencies_ ) dependencies_->required.push_back(s);
+                    return std::forward<F>(f);
+                }
         };
     }
 }
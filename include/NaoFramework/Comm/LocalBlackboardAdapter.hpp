@@ -3,8 +3,10 @@
 
 #include <NaoFramework/Comm/Types.hpp>
 #include <NaoFramework/Comm/Blackboard.hpp>
+#include <NaoFramework/Comm/Dependencies.hpp>
 
 #include <functional>
+#include <utility>
 
 namespace NaoFramework {
     namespace Comm {
@@ -14,6 +16,9 @@ namespace NaoFramework {
          * This adapter is provided as a means to shield/block modules registering requests to their
          * local Blackboard from using non-local functions. All functions are simply redirects to
          * their equivalent functions within Blackboard.
+         *
+         * In addition, the adapter keeps track of all successful registrations, so that the
+         * framework knows which keys each module uses.
          */
         class LocalBlackboardAdapter {
             public:
@@ -27,22 +32,48 @@ namespace NaoFramework {
                 /// \sa Blackboard::registerRequire()
                 template <class T>
                 RequireFunction<T> registerRequire          (const std::string & s, RegistrationError * e = nullptr) {
-                    return blackboard_.registerRequire<T>(s,e);
+                    return recordRequire(s, blackboard_.registerRequire<T>(s,e));
+                }
+
+                /// \sa Blackboard::registerRequireView()
+                template <class T>
+                ViewFunction<T>    registerRequireView      (const std::string & s, RegistrationError * e = nullptr) {
+                    return recordRequire(s, blackboard_.registerRequireView<T>(s,e));
                 }
 
                 /// \sa Blackboard::registerProvide()
                 template <class T>
                 ProvideFunction<T> registerProvide          (const std::string & s, RegistrationError * e = nullptr) {
-                    return blackboard_.registerProvide<T>(s,e);
+                    return recordProvide(s, blackboard_.registerProvide<T>(s,e));
                 }
 
                 /// \sa Blackboard::registerGlobalProvide()
                 template <class T>
                 ProvideFunction<T> registerGlobalProvide    (const std::string & s, const T & v, RegistrationError * e = nullptr) {
-                    return blackboard_.registerGlobalProvide<T>(s, v, e);
+                    return recordProvide(s, blackboard_.registerGlobalProvide<T>(s, v, e));
                 }
+
+                /**
+                 * @brief This function returns the keys successfully registered through this adapter.
+                 *
+                 * @return The dependencies registered so far.
+                 */
+                const Dependencies & getDependencies() const { return dependencies_; }
             private:
                 Blackboard & blackboard_;
+                Dependencies dependencies_;
+
+                template <class F>
+                F recordRequire(const std::string & s, F && f) {
+                    if ( f ) dependencies_.required.push_back(s);
+                    return std::forward<F>(f);
+                }
+
+                template <class F>
+                F recordProvide(const std::string & s, F && f) {
+                    if ( f ) dependencies_.provided.push_back(s);
+                    return std::forward<F>(f);
+                }
         };
     }
 }
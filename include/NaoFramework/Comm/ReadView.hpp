@@ -0,0 +1,119 @@
+#ifndef NAO_FRAMEWORK_COMM_READ_VIEW_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_READ_VIEW_HEADER_FILE
+
+#include <atomic>
+
+#include <boost/thread/shared_mutex.hpp>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This class provides read-only access to Blackboard data without copying it.
+         *
+         * A ReadView keeps the data it points to alive and unchanged for as long as it exists.
+         * Depending on how the data is shared, it does so by holding a shared lock, by pinning
+         * a buffer so that writers from other threads publish elsewhere, or by doing nothing
+         * when the data is only used by the current thread.
+         *
+         * A ReadView should be dropped within the execute() call which created it. In particular,
+         * it must be dropped before the same thread provides the same key again, as a held lock
+         * would otherwise block the provider forever.
+         *
+         * @tparam T The type of the viewed data.
+         */
+        template <class T>
+        class ReadView {
+            public:
+                /**
+                 * @brief Basic constructor, creates an empty view.
+                 */
+                ReadView() : data_(nullptr), pin_(nullptr), lock_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates a view on data which needs no protection.
+                 *
+                 * @param data The viewed data.
+                 */
+                explicit ReadView(const T & data) : data_(&data), pin_(nullptr), lock_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates a view on a pinned buffer.
+                 *
+                 * @param data The viewed data.
+                 * @param pin The reader count of the buffer, already incremented.
+                 */
+                ReadView(const T & data, std::atomic<unsigned> & pin) : data_(&data), pin_(&pin), lock_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates a view on locked data.
+                 *
+                 * @param data The viewed data.
+                 * @param lock The lock protecting the data, already locked in shared mode.
+                 */
+                ReadView(const T & data, boost::shared_mutex & lock) : data_(&data), pin_(nullptr), lock_(&lock) {}
+
+                /**
+                 * @brief Basic destructor, releases the viewed data.
+                 */
+                ~ReadView() { release(); }
+
+                ReadView(const ReadView &) = delete;
+                ReadView & operator=(const ReadView &) = delete;
+
+                /**
+                 * @brief Move constructor, transfers ownership of the view.
+                 *
+                 * @param other The moved view.
+                 */
+                ReadView(ReadView && other) : data_(other.data_), pin_(other.pin_), lock_(other.lock_) {
+                    other.data_ = nullptr;
+                    other.pin_  = nullptr;
+                    other.lock_ = nullptr;
+                }
+
+                /**
+                 * @brief Move assignment operator, releases the current view and takes the other.
+                 *
+                 * @param other The moved view.
+                 *
+                 * @return The view itself.
+                 */
+                ReadView & operator=(ReadView && other) {
+                    if ( this == &other ) return *this;
+                    release();
+
+                    data_ = other.data_;
+                    pin_  = other.pin_;
+                    lock_ = other.lock_;
+
+                    other.data_ = nullptr;
+                    other.pin_  = nullptr;
+                    other.lock_ = nullptr;
+
+                    return *this;
+                }
+
+                /**
+                 * @brief This function checks whether the view points to any data.
+                 *
+                 * @return True if the view is not empty, false otherwise.
+                 */
+                explicit operator bool() const { return data_ != nullptr; }
+
+                const T & operator*()  const { return *data_; }
+                const T * operator->() const { return data_; }
+
+            private:
+                const T * data_;
+                std::atomic<unsigned> * pin_;
+                boost::shared_mutex * lock_;
+
+                void release() {
+                    if ( pin_ )  pin_->fetch_sub(1, std::memory_order_release);
+                    if ( lock_ ) lock_->unlock_shared();
+                }
+        };
+    }
+}
+
+#endif
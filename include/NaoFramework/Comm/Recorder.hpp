@@ -0,0 +1,131 @@
+#ifndef NAO_FRAMEWORK_COMM_RECORDER_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_RECORDER_HEADER_FILE
+
+#include <NaoFramework/Comm/Serializer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Comm {
+        /*
+         * A recording starts with Magic, followed by entries. Each entry starts with its
+         * EntryType byte. Numbers are in the byte order of the recording machine.
+         *
+         *  KeyEntry:    uint32 id, then blackboard, key and type name, each as uint32 size and bytes
+         *  SampleEntry: uint32 key id, int64 nanoseconds since the start of the recording,
+         *               uint64 cycle of the wave, uint32 size, data written by the Serializer
+         */
+        namespace Recording {
+            constexpr char Magic[8] = { 'N', 'A', 'O', 'R', 'E', 'C', '1', '\0' };
+
+            enum EntryType : uint8_t {
+                KeyEntry = 1,
+                SampleEntry
+            };
+        }
+
+        /**
+         * @brief This class records the data provided on Blackboard keys into a memory-mapped file.
+         *
+         * Slots of recorded keys call record() after each write, from whichever thread
+         * provides them. Samples are appended to the mapping under a mutex; the file grows
+         * in large steps, so that appending is normally a copy into memory, and the kernel
+         * writes the pages to disk in the background.
+         *
+         * Once finished, the Recorder ignores further samples, but it must outlive the
+         * slots pointing to it, as a writer may have just read the pointer.
+         */
+        class Recorder {
+            public:
+                /**
+                 * @brief Basic constructor, creates the file.
+                 *
+                 * @param filename The name of the file to create.
+                 */
+                Recorder(const std::string & filename);
+
+                /**
+                 * @brief Basic destructor, finishes the recording.
+                 */
+                ~Recorder();
+
+                Recorder(const Recorder &) = delete;
+                Recorder & operator=(const Recorder &) = delete;
+
+                /**
+                 * @brief This function checks whether the file could be created.
+                 *
+                 * @return True if the Recorder is recording, false otherwise.
+                 */
+                bool isOpen() const;
+
+                /**
+                 * @brief This function adds a key to the recording.
+                 *
+                 * @param blackboard The name of the Blackboard of the key.
+                 * @param key The key.
+                 * @param type The name of the type of the key, as given by typeid.
+                 * @param cycles The cycle counter of the wave providing the key, or nullptr.
+                 *
+                 * @return The id to record samples of the key with.
+                 */
+                uint32_t addKey(const std::string & blackboard, const std::string & key, const std::string & type,
+                                const std::atomic<unsigned long> * cycles);
+
+                /**
+                 * @brief This function records a sample of a key.
+                 *
+                 * @tparam T The type of the key, which must have a Serializer.
+                 * @param id The id of the key.
+                 * @param value The data provided.
+                 */
+                template <class T>
+                void record(uint32_t id, const T & value) {
+                    // Kept between calls, so that recording does not allocate once warmed up.
+                    static thread_local std::string buffer;
+                    buffer.clear();
+                    Serializer<T>::write(buffer, value);
+                    append(id, buffer);
+                }
+
+                /**
+                 * @brief This function stops the recording, and truncates the file to its content.
+                 *
+                 * This also happens on its own if the file cannot grow, for example when the
+                 * disk is full.
+                 */
+                void finish();
+
+                /**
+                 * @brief This function returns the number of samples recorded.
+                 *
+                 * @return The number of samples.
+                 */
+                unsigned long getSamples() const;
+
+            private:
+                std::string filename_;
+                int fd_;
+                char * map_;
+                size_t capacity_;
+                size_t size_;
+                unsigned long samples_;
+                std::chrono::steady_clock::time_point start_;
+                std::vector<const std::atomic<unsigned long> *> cycles_;
+                mutable std::mutex mutex_;
+
+                void append(uint32_t id, const std::string & data);
+                // These must be called with the mutex held.
+                bool reserve(size_t size);
+                void write(const void * data, size_t size);
+                void release();
+        };
+    }
+}
+
+#endif
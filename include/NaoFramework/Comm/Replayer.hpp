@@ -0,0 +1,122 @@
+#ifndef NAO_FRAMEWORK_COMM_REPLAYER_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_REPLAYER_HEADER_FILE
+
+#include <NaoFramework/Comm/Recorder.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Comm {
+        class Blackboard;
+        class SlotBase;
+        /**
+         * @brief This class provides the data of a recording to a Blackboard, cycle by cycle.
+         *
+         * The recording is memory-mapped, and samples are written straight from the mapping
+         * into the slots of the replayed keys. Replayed keys take the place of the modules
+         * which provided them while recording, so they must only be required.
+         *
+         * Samples are replayed by cycle rather than by time: each call to provide() writes
+         * the samples recorded during the next recorded cycle, so a wave running back-to-back
+         * replays as fast as its modules allow.
+         */
+        class Replayer {
+            public:
+                /**
+                 * @brief Basic constructor, maps and indexes the recording.
+                 *
+                 * @param filename The name of the recording.
+                 */
+                Replayer(const std::string & filename);
+
+                /**
+                 * @brief Basic destructor, unmaps the recording.
+                 */
+                ~Replayer();
+
+                Replayer(const Replayer &) = delete;
+                Replayer & operator=(const Replayer &) = delete;
+
+                /**
+                 * @brief This function checks whether the recording could be read.
+                 *
+                 * @return True if the recording is valid, false otherwise.
+                 */
+                bool isOpen() const;
+
+                /**
+                 * @brief This function registers the keys recorded from a Blackboard with the same name.
+                 *
+                 * Keys which are not required with the recorded type, or which are provided by
+                 * a module, are skipped. This must be called once, after adding the modules
+                 * and before running the wave.
+                 *
+                 * @param blackboard The Blackboard to provide the keys to.
+                 * @param skipped The keys which could not be replayed.
+                 *
+                 * @return The number of keys replayed.
+                 */
+                unsigned attach(Blackboard & blackboard, std::vector<std::string> & skipped);
+
+                /**
+                 * @brief This function gives the replayed keys of a Blackboard back to their modules.
+                 *
+                 * The keys become required only again, so they can be replayed or provided by a
+                 * module later. Nothing is replayed afterwards. This must be called while the
+                 * wave is paused.
+                 *
+                 * @param blackboard The Blackboard the keys were provided to.
+                 */
+                void detach(Blackboard & blackboard);
+
+                /**
+                 * @brief This function writes the samples of the next recorded cycle.
+                 *
+                 * This is called by the wave at the start of each cycle.
+                 *
+                 * @param cycle The number of the cycle being started.
+                 */
+                void provide(unsigned long cycle);
+
+                /**
+                 * @brief This function checks whether all samples have been replayed.
+                 *
+                 * @return True if the replay is over, false otherwise.
+                 */
+                bool isFinished() const;
+
+            private:
+                struct Key {
+                    std::string blackboard;
+                    std::string name;
+                    std::string type;
+                    SlotBase * slot;
+                };
+
+                struct Sample {
+                    uint32_t key;
+                    uint64_t cycle;
+                    const char * data;
+                    uint32_t size;
+                };
+
+                char * map_;
+                size_t size_;
+                std::vector<Key> keys_;
+                std::vector<Sample> samples_;
+
+                // Only used by the wave thread.
+                size_t next_;
+                bool started_;
+                uint64_t offset_;
+                std::atomic<bool> finished_;
+
+                bool index();
+        };
+    }
+}
+
+#endif
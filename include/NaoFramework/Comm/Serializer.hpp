@@ -0,0 +1,95 @@
+#ifndef NAO_FRAMEWORK_COMM_SERIALIZER_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_SERIALIZER_HEADER_FILE
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This class converts Blackboard data to and from bytes, to record and replay it.
+         *
+         * Only types with a Serializer can be recorded. Trivially copyable types, strings
+         * and vectors of trivially copyable types are serialized out of the box. Other types
+         * need a specialization, with the same members as these ones:
+         *
+         *     namespace NaoFramework { namespace Comm {
+         *         template <>
+         *         struct Serializer<Pose> {
+         *             static constexpr bool Available = true;
+         *             static void write(std::string & buffer, const Pose & value);
+         *             static bool read(const char *& data, const char * end, Pose & value);
+         *         };
+         *     }}
+         *
+         * write() appends the value to the buffer. read() reads a value, moves data past it
+         * and returns false if the bytes up to end do not hold a valid value.
+         *
+         * Data is written with the byte order and layout of the recording machine.
+         *
+         * @tparam T The type of the data.
+         */
+        template <class T, class Enable = void>
+        struct Serializer {
+            static constexpr bool Available = false;
+        };
+
+        template <class T>
+        struct Serializer<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+            static constexpr bool Available = true;
+
+            static void write(std::string & buffer, const T & value) {
+                buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            static bool read(const char *& data, const char * end, T & value) {
+                if ( static_cast<size_t>(end - data) < sizeof(T) ) return false;
+                std::memcpy(&value, data, sizeof(T));
+                data += sizeof(T);
+                return true;
+            }
+        };
+
+        template <>
+        struct Serializer<std::string> {
+            static constexpr bool Available = true;
+
+            static void write(std::string & buffer, const std::string & value) {
+                Serializer<uint32_t>::write(buffer, value.size());
+                buffer.append(value);
+            }
+
+            static bool read(const char *& data, const char * end, std::string & value) {
+                uint32_t size;
+                if ( !Serializer<uint32_t>::read(data, end, size) || static_cast<size_t>(end - data) < size ) return false;
+                value.assign(data, size);
+                data += size;
+                return true;
+            }
+        };
+
+        template <class T>
+        struct Serializer<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value>::type> {
+            static constexpr bool Available = true;
+
+            static void write(std::string & buffer, const std::vector<T> & value) {
+                Serializer<uint32_t>::write(buffer, value.size());
+                buffer.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(T));
+            }
+
+            static bool read(const char *& data, const char * end, std::vector<T> & value) {
+                uint32_t size;
+                if ( !Serializer<uint32_t>::read(data, end, size) || static_cast<size_t>(end - data) / sizeof(T) < size ) return false;
+                value.resize(size);
+                std::memcpy(value.data(), data, size * sizeof(T));
+                data += size * sizeof(T);
+                return true;
+            }
+        };
+    }
+}
+
+#endif
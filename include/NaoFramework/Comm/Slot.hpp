@@ -0,0 +1,342 @@
+#ifndef NAO_FRAMEWORK_COMM_SLOT_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_SLOT_HEADER_FILE
+
+#include <NaoFramework/Comm/TripleBuffer.hpp>
+#include <NaoFramework/Comm/ReadView.hpp>
+#include <NaoFramework/Comm/Trigger.hpp>
+#include <NaoFramework/Comm/Recorder.hpp>
+
+#include <atomic>
+#include <memory>
+#include <typeindex>
+#include <utility>
+
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This class is the untyped base of all Blackboard slots.
+         *
+         * A slot holds the data of a single Blackboard key. Slots are created during
+         * registration with the type of their key, and never move afterwards, so that
+         * accessors can keep pointers to them without looking keys up.
+         *
+         * Since accessors may be created before it is known how a key is going to be
+         * shared, they check the access mode of the slot on each call.
+         */
+        class SlotBase {
+            public:
+                enum class Access {
+                    Locked,             // Data is in value, protected by lock.
+                    Unlocked,           // Data is in value, only used by the local thread.
+                    Buffered            // Data is in buffer, the key is globally provided.
+                };
+
+                /**
+                 * @brief Basic constructor.
+                 *
+                 * @param type The type of the data held in the slot.
+                 */
+                SlotBase(std::type_index type) : access_(Access::Locked), recorder_(nullptr), recordId_(0), trigger_(nullptr), type_(type) {}
+
+                /**
+                 * @brief Virtual destructor.
+                 *
+                 * The data is destroyed by the child, which lives in whichever code
+                 * registered the key first.
+                 */
+                virtual ~SlotBase() {}
+
+                SlotBase(const SlotBase &) = delete;
+                SlotBase & operator=(const SlotBase &) = delete;
+
+                /**
+                 * @brief This function returns how the data of the slot is accessed.
+                 *
+                 * @return The current access mode.
+                 */
+                Access getAccess() const { return access_.load(std::memory_order_acquire); }
+
+                /**
+                 * @brief This function removes locking from a slot used by a single thread.
+                 *
+                 * This must not be called on a Buffered slot.
+                 */
+                void unlock() { access_.store(Access::Unlocked, std::memory_order_release); }
+
+                /**
+                 * @brief This function returns the type of the data held in the slot.
+                 *
+                 * @return The type of the data.
+                 */
+                std::type_index getType() const { return type_; }
+
+                /**
+                 * @brief This function returns the Trigger notified on each write, creating it if needed.
+                 *
+                 * Slots without a Trigger don't pay anything for it when written.
+                 *
+                 * @return The Trigger of the slot.
+                 */
+                Trigger & getTrigger() {
+                    if ( !ownedTrigger_ ) {
+                        ownedTrigger_.reset(new Trigger());
+                        trigger_.store(ownedTrigger_.get(), std::memory_order_release);
+                    }
+                    return *ownedTrigger_;
+                }
+
+                /**
+                 * @brief This function makes all following writes be recorded.
+                 *
+                 * The provider may be writing meanwhile, so a recorded slot must be stopped
+                 * before being given another Recorder: the provider could otherwise pair
+                 * the old Recorder with the new id. A writer which still sees a stopped
+                 * Recorder is harmless once that Recorder is finished.
+                 *
+                 * @param recorder The Recorder to record into, nullptr to stop recording.
+                 * @param id The id of the key in the Recorder.
+                 */
+                void setRecorder(Recorder * recorder, uint32_t id) {
+                    recordId_.store(id, std::memory_order_relaxed);
+                    recorder_.store(recorder, std::memory_order_release);
+                }
+
+                /**
+                 * @brief This function checks whether writes are being recorded.
+                 *
+                 * @return True if the slot has a Recorder, false otherwise.
+                 */
+                bool isRecorded() const {
+                    return recorder_.load(std::memory_order_acquire) != nullptr;
+                }
+
+                /**
+                 * @brief This function checks whether the data of the slot can be recorded and replayed.
+                 *
+                 * @return True if the type of the data has a Serializer, false otherwise.
+                 */
+                virtual bool isSerializable() const = 0;
+
+                /**
+                 * @brief This function writes data read by the Serializer of the slot's type.
+                 *
+                 * @param data The serialized data.
+                 * @param size The size of the data.
+                 *
+                 * @return True if the data was valid and written, false otherwise.
+                 */
+                virtual bool writeSerialized(const char * data, size_t size) = 0;
+
+                /**
+                 * @brief This function moves the current data of the slot into a TripleBuffer.
+                 *
+                 * \sa Slot::makeGlobal()
+                 */
+                virtual void makeBuffered() = 0;
+
+            protected:
+                std::atomic<Access> access_;
+                std::atomic<Recorder*> recorder_;
+                std::atomic<uint32_t> recordId_;
+
+                /**
+                 * @brief This function notifies the Trigger of the slot, if any.
+                 *
+                 * It must be called by children after each write.
+                 */
+                void notifyWrite() {
+                    auto trigger = trigger_.load(std::memory_order_acquire);
+                    if ( trigger ) trigger->notify();
+                }
+
+            private:
+                std::atomic<Trigger*> trigger_;
+                std::unique_ptr<Trigger> ownedTrigger_;
+                std::type_index type_;
+        };
+
+        /**
+         * @brief This class holds the data of a single Blackboard key of type T.
+         *
+         * Reads and writes are done directly on T, so they do not allocate unless
+         * copying T itself does.
+         *
+         * @tparam T The type of the data. It must be default constructible and copy assignable.
+         */
+        template <class T>
+        class Slot : public SlotBase {
+            public:
+                /**
+                 * @brief Basic constructor.
+                 *
+                 * Until something is provided, the slot holds a default constructed T.
+                 */
+                Slot() : SlotBase(typeid(T)) {}
+
+                /**
+                 * @brief This function moves the data of the slot into a TripleBuffer.
+                 *
+                 * This is used when the key gets globally provided, and it is
+                 * irreversible. If the key was already globally provided, as when
+                 * a module is reloaded, readers in other threads may be using the
+                 * buffer, so it is kept together with its current data.
+                 *
+                 * @param value The initial value of the data.
+                 */
+                void makeGlobal(const T & value) {
+                    if ( getAccess() == Access::Buffered ) return;
+
+                    buffer_.reset(new TripleBuffer<T>());
+                    buffer_->write(value);
+                    access_.store(Access::Buffered, std::memory_order_release);
+                }
+
+                virtual void makeBuffered() override {
+                    makeGlobal(value_);
+                }
+
+                virtual bool isSerializable() const override {
+                    return Serializer<T>::Available;
+                }
+
+                virtual bool writeSerialized(const char * data, size_t size) override {
+                    return writeSerialized(data, size, std::integral_constant<bool, Serializer<T>::Available>());
+                }
+
+                /**
+                 * @brief This function returns a copy of the data.
+                 *
+                 * @return The data in the slot.
+                 */
+                T read() const {
+                    auto access = getAccess();
+                    if ( access == Access::Unlocked )
+                        return value_;
+                    if ( access == Access::Buffered )
+                        return buffer_->read();
+
+                    ReadLock lock(lock_);
+
+                    return value_;
+                }
+
+                /**
+                 * @brief This function returns a view on the data, without copying it.
+                 *
+                 * @return A view on the data in the slot.
+                 */
+                ReadView<T> view() const {
+                    auto access = getAccess();
+                    if ( access == Access::Unlocked )
+                        return ReadView<T>(value_);
+                    if ( access == Access::Buffered )
+                        return buffer_->view();
+
+                    lock_.lock_shared();
+                    return ReadView<T>(value_, lock_);
+                }
+
+                /**
+                 * @brief This function sets the data.
+                 *
+                 * @param input The new data.
+                 */
+                void write(const T & input) {
+                    auto access = getAccess();
+                    if ( access == Access::Unlocked )
+                        value_ = input;
+                    else if ( access == Access::Buffered )
+                        buffer_->write(input);
+                    else {
+                        WriteLock lock(lock_);
+
+                        value_ = input;
+                    }
+                    notifyWrite();
+                    recordWrite();
+                }
+
+                /**
+                 * @brief This function sets the data by moving the input.
+                 *
+                 * @param input The new data.
+                 */
+                void write(T && input) {
+                    auto access = getAccess();
+                    if ( access == Access::Unlocked )
+                        value_ = std::move(input);
+                    else if ( access == Access::Buffered )
+                        buffer_->write(std::move(input));
+                    else {
+                        WriteLock lock(lock_);
+
+                        value_ = std::move(input);
+                    }
+                    notifyWrite();
+                    recordWrite();
+                }
+
+                /**
+                 * @brief This function lets a function write the data in place.
+                 *
+                 * \sa TripleBuffer::update()
+                 *
+                 * @param f The function writing the data.
+                 */
+                template <class F>
+                void update(F && f) {
+                    auto access = getAccess();
+                    if ( access == Access::Unlocked )
+                        f(value_);
+                    else if ( access == Access::Buffered )
+                        buffer_->update(std::forward<F>(f));
+                    else {
+                        WriteLock lock(lock_);
+
+                        f(value_);
+                    }
+                    notifyWrite();
+                    recordWrite();
+                }
+
+            private:
+                void recordWrite() {
+                    recordWrite(std::integral_constant<bool, Serializer<T>::Available>());
+                }
+
+                void recordWrite(std::true_type) {
+                    auto recorder = recorder_.load(std::memory_order_acquire);
+                    if ( !recorder ) return;
+                    // Only the provider writes, so this is the data just written.
+                    auto data = view();
+                    recorder->record(recordId_.load(std::memory_order_relaxed), *data);
+                }
+
+                void recordWrite(std::false_type) {}
+
+                bool writeSerialized(const char * data, size_t size, std::true_type) {
+                    T value;
+                    if ( !Serializer<T>::read(data, data + size, value) ) return false;
+                    write(std::move(value));
+                    return true;
+                }
+
+                bool writeSerialized(const char *, size_t, std::false_type) {
+                    return false;
+                }
+
+                using Lock = boost::shared_mutex;
+                using WriteLock = boost::unique_lock<Lock>;
+                using ReadLock  = boost::shared_lock<Lock>;
+
+                mutable Lock lock_;
+                T value_;
+                std::unique_ptr<TripleBuffer<T>> buffer_;
+        };
+    }
+}
+
+#endif
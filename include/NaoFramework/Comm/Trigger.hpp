@@ -0,0 +1,80 @@
+#ifndef NAO_FRAMEWORK_COMM_TRIGGER_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_TRIGGER_HEADER_FILE
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This class allows threads to wait for updates of a Blackboard key.
+         *
+         * A Trigger counts how many times its key has been provided. Threads can wait
+         * for the count to change, and get woken up as soon as a new value is provided.
+         *
+         * Notifying is cheap when nobody is waiting, as the mutex is only touched when
+         * there are waiters to wake up.
+         */
+        class Trigger {
+            public:
+                /**
+                 * @brief Basic constructor.
+                 */
+                Trigger() : count_(0), waiters_(0) {}
+
+                Trigger(const Trigger &) = delete;
+                Trigger & operator=(const Trigger &) = delete;
+
+                /**
+                 * @brief This function signals that the key has been provided.
+                 */
+                void notify() {
+                    count_.fetch_add(1, std::memory_order_seq_cst);
+                    if ( waiters_.load(std::memory_order_seq_cst) == 0 ) return;
+                    // Taking the mutex makes sure that waiters are either still going to
+                    // check the count, or are already waiting and will be woken up.
+                    { std::lock_guard<std::mutex> lock(mutex_); }
+                    condition_.notify_all();
+                }
+
+                /**
+                 * @brief This function returns the number of times the key has been provided.
+                 *
+                 * @return The number of notifications received.
+                 */
+                unsigned long getCount() const {
+                    return count_.load(std::memory_order_seq_cst);
+                }
+
+                /**
+                 * @brief This function waits for a notification.
+                 *
+                 * @param last The last count seen by the caller.
+                 * @param timeout The maximum time to wait.
+                 *
+                 * @return The current count, which is equal to last if the wait timed out.
+                 */
+                template <class Rep, class Period>
+                unsigned long waitFor(unsigned long last, std::chrono::duration<Rep, Period> timeout) {
+                    waiters_.fetch_add(1, std::memory_order_seq_cst);
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        condition_.wait_for(lock, timeout, [this, last](){ return getCount() != last; });
+                    }
+                    waiters_.fetch_sub(1, std::memory_order_seq_cst);
+
+                    return getCount();
+                }
+
+            private:
+                std::atomic<unsigned long> count_;
+                std::atomic<unsigned> waiters_;
+                std::mutex mutex_;
+                std::condition_variable condition_;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef NAO_FRAMEWORK_COMM_TRIPLE_BUFFER_HEADER_FILE
+#define NAO_FRAMEWORK_COMM_TRIPLE_BUFFER_HEADER_FILE
+
+#include <NaoFramework/Comm/ReadView.hpp>
+
+#include <atomic>
+#include <deque>
+#include <utility>
+
+namespace NaoFramework {
+    namespace Comm {
+        /**
+         * @brief This class provides single-writer/multi-reader storage that never blocks the writer.
+         *
+         * The buffer keeps a small pool of values, one of which is the latest complete value.
+         * Readers pin the latest value while they read it, and the writer always writes into a
+         * value that is neither the latest nor pinned, publishing it atomically once done.
+         * As long as readers are not slower than two whole writes, three values are enough.
+         * If the writer cannot find a free value it adds a new one to the pool instead of
+         * waiting, so the writer never waits on readers and readers never wait on the writer.
+         *
+         * Only a single thread may write to a TripleBuffer at any given time, while any number
+         * of threads can read from it concurrently.
+         *
+         * @tparam T The type of the stored data. It must be default constructible and copy assignable.
+         */
+        template <class T>
+        class TripleBuffer {
+            public:
+                /**
+                 * @brief Basic constructor.
+                 *
+                 * All buffers are default constructed.
+                 */
+                TripleBuffer() : buffers_(3), latest_(&buffers_.front()) {}
+
+                TripleBuffer(const TripleBuffer &) = delete;
+                TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+                /**
+                 * @brief This function publishes a new value.
+                 *
+                 * This function must only be called by the single writer.
+                 *
+                 * @param value The new value.
+                 */
+                void write(const T & value) {
+                    auto buffer = getFreeBuffer();
+                    buffer->value = value;
+                    latest_.store(buffer, std::memory_order_seq_cst);
+                }
+
+                /**
+                 * @brief This function publishes a new value by moving it.
+                 *
+                 * This function must only be called by the single writer.
+                 *
+                 * @param value The new value.
+                 */
+                void write(T && value) {
+                    auto buffer = getFreeBuffer();
+                    buffer->value = std::move(value);
+                    latest_.store(buffer, std::memory_order_seq_cst);
+                }
+
+                /**
+                 * @brief This function publishes a new value written in place.
+                 *
+                 * The function receives a buffer which is not being read, containing an
+                 * older value, and should overwrite it completely. This allows to reuse
+                 * memory owned by the value.
+                 *
+                 * This function must only be called by the single writer.
+                 *
+                 * @param f The function writing the value.
+                 */
+                template <class F>
+                void update(F && f) {
+                    auto buffer = getFreeBuffer();
+                    f(buffer->value);
+                    latest_.store(buffer, std::memory_order_seq_cst);
+                }
+
+                /**
+                 * @brief This function returns a copy of the latest published value.
+                 *
+                 * @return The latest value.
+                 */
+                T read() const {
+                    return *view();
+                }
+
+                /**
+                 * @brief This function returns a view on the latest published value.
+                 *
+                 * The viewed value stays pinned until the view is dropped, and the writer
+                 * publishes new values elsewhere in the meantime.
+                 *
+                 * @return A view on the latest value.
+                 */
+                ReadView<T> view() const {
+                    auto buffer = pin();
+                    return ReadView<T>(buffer->value, buffer->readers);
+                }
+
+            private:
+                struct Buffer {
+                    Buffer() : readers(0) {}
+
+                    mutable std::atomic<unsigned> readers;
+                    T value;
+                };
+
+                // Only touched by the writer, so it can grow without locks.
+                // A deque never moves its elements, so readers can keep their pointers.
+                std::deque<Buffer> buffers_;
+                std::atomic<Buffer*> latest_;
+
+                Buffer * getFreeBuffer() {
+                    // We are the only ones storing to latest_.
+                    auto latest = latest_.load(std::memory_order_relaxed);
+                    for ( auto & buffer : buffers_ )
+                        if ( &buffer != latest && buffer.readers.load(std::memory_order_seq_cst) == 0 )
+                            return &buffer;
+                    // Every other buffer is being read, we don't wait.
+                    buffers_.emplace_back();
+                    return &buffers_.back();
+                }
+
+                Buffer * pin() const {
+                    auto buffer = latest_.load(std::memory_order_seq_cst);
+                    while ( true ) {
+                        buffer->readers.fetch_add(1, std::memory_order_seq_cst);
+                        // If this is still the latest buffer the writer will see our pin
+                        // before choosing where to write next, so it is safe to read.
+                        auto latest = latest_.load(std::memory_order_seq_cst);
+                        if ( latest == buffer ) return buffer;
+
+                        buffer->readers.fetch_sub(1, std::memory_order_release);
+                        buffer = latest;
+                    }
+                }
+        };
+    }
+}
+
+#endif
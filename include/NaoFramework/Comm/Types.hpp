@@ -1,7 +1,10 @@
 #ifndef NAO_FRAMEWORK_COMM_TYPES_HEADER_FILE
 #define NAO_FRAMEWORK_COMM_TYPES_HEADER_FILE
 
-#include <functional>
+#include <NaoFramework/Comm/Slot.hpp>
+#include <NaoFramework/Comm/ReadView.hpp>
+
+#include <utility>
 
 namespace NaoFramework {
     namespace Comm {
@@ -15,10 +18,164 @@ namespace NaoFramework {
             GloballyProvided,
             WrongType
         };
+
+        /**
+         * @brief This class is the accessor returned by Blackboard require registrations.
+         *
+         * This is a lightweight handle pointing directly to the data slot, so it can be copied
+         * freely and calls to it can be inlined in the caller.
+         *
+         * The returned data is a copy, so you may want to store the result somewhere
+         * or it gets expensive. For large data, use RequireView instead.
+         *
+         * @tparam T The type of the data required.
+         */
+        template <class T>
+        class Require {
+            public:
+                /**
+                 * @brief Basic constructor, creates an empty accessor.
+                 */
+                Require() : slot_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates an accessor to the given slot.
+                 *
+                 * @param slot The slot holding the data.
+                 */
+                explicit Require(Slot<T> & slot) : slot_(&slot) {}
+
+                /**
+                 * @brief This function returns a copy of the data.
+                 *
+                 * @return The data.
+                 */
+                T operator()() const { return slot_->read(); }
+
+                /**
+                 * @brief This function checks whether the accessor is usable.
+                 *
+                 * @return True if the registration was successful, false otherwise.
+                 */
+                explicit operator bool() const { return slot_ != nullptr; }
+
+            private:
+                Slot<T> * slot_;
+        };
+
+        /**
+         * @brief This class is the accessor returned by Blackboard view registrations.
+         *
+         * This works as Require, but returns a ReadView on the data instead of a copy.
+         *
+         * @tparam T The type of the data required.
+         */
+        template <class T>
+        class RequireView {
+            public:
+                /**
+                 * @brief Basic constructor, creates an empty accessor.
+                 */
+                RequireView() : slot_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates an accessor to the given slot.
+                 *
+                 * @param slot The slot holding the data.
+                 */
+                explicit RequireView(Slot<T> & slot) : slot_(&slot) {}
+
+                /**
+                 * @brief This function returns a view on the data.
+                 *
+                 * @return A view on the data.
+                 */
+                ReadView<T> operator()() const { return slot_->view(); }
+
+                /**
+                 * @brief This function checks whether the accessor is usable.
+                 *
+                 * @return True if the registration was successful, false otherwise.
+                 */
+                explicit operator bool() const { return slot_ != nullptr; }
+
+            private:
+                Slot<T> * slot_;
+        };
+
+        /**
+         * @brief This class is the accessor returned by Blackboard provide registrations.
+         *
+         * This is a lightweight handle pointing directly to the data slot, so it can be copied
+         * freely and calls to it can be inlined in the caller.
+         *
+         * Data can be provided by copy, by move, or by updating it in place. Moving or
+         * updating in place lets producers hand over or refill their buffers without
+         * copying them.
+         *
+         * @tparam T The type of the data provided.
+         */
+        template <class T>
+        class Provide {
+            public:
+                /**
+                 * @brief Basic constructor, creates an empty accessor.
+                 */
+                Provide() : slot_(nullptr) {}
+
+                /**
+                 * @brief This constructor creates an accessor to the given slot.
+                 *
+                 * @param slot The slot holding the data.
+                 */
+                explicit Provide(Slot<T> & slot) : slot_(&slot) {}
+
+                /**
+                 * @brief This function provides a copy of the input.
+                 *
+                 * @param input The new data.
+                 */
+                void operator()(const T & input) const { slot_->write(input); }
+
+                /**
+                 * @brief This function provides the input by moving it.
+                 *
+                 * @param input The new data.
+                 */
+                void operator()(T && input) const { slot_->write(std::move(input)); }
+
+                /**
+                 * @brief This function lets the caller write the data in place.
+                 *
+                 * The function receives a reference to the data while it is safe to write it.
+                 * The previous content of the reference is unspecified: for globally provided data
+                 * it is an older value whose memory is being reused, so it should be completely
+                 * overwritten (or swapped with the caller's buffer).
+                 *
+                 * @tparam F A callable taking a T&.
+                 * @param f The function writing the data.
+                 */
+                template <class F>
+                void update(F && f) const { slot_->update(std::forward<F>(f)); }
+
+                /**
+                 * @brief This function checks whether the accessor is usable.
+                 *
+                 * @return True if the registration was successful, false otherwise.
+                 */
+                explicit operator bool() const { return slot_ != nullptr; }
+
+            private:
+                Slot<T> * slot_;
+        };
+
+        // Names kept from when accessors were std::function objects.
+        template <class T>
+        using ProvideFunction   = Provide<T>;
         template <class T>
-        using ProvideFunction   = std::function<void(const T&)>;
+        using RequireFunction   = Require<T>;
         template <class T>
-        using RequireFunction   = std::function<T()>;
+        using ViewFunction      = RequireView<T>;
     }
 }
 
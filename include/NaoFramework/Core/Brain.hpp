@@ -3,11 +3,17 @@
 
 #include <NaoFramework/Modules/DynamicModule.hpp>
 #include <NaoFramework/Comm/Blackboard.hpp>
+#include <NaoFramework/Comm/Recorder.hpp>
+#include <NaoFramework/Comm/Replayer.hpp>
 #include <NaoFramework/Core/BrainWave.hpp>
+#include <NaoFramework/Core/Watchdog.hpp>
 
 #include <string>
 #include <vector>
 #include <list>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include <unordered_map>
 
 namespace NaoFramework {
@@ -51,11 +57,93 @@ namespace NaoFramework {
                 // to give the API of the framework.
                 unsigned createWave         (Inputs inputs);
                 unsigned addDynamicModule   (Inputs inputs);
+                unsigned reloadDynamicModule(Inputs inputs);
+                unsigned loadDynamicModules (Inputs inputs);
+                unsigned printStartup       (Inputs inputs);
                 unsigned execute            (Inputs inputs);
+                unsigned setWavePeriod      (Inputs inputs);
+                unsigned setWaveTrigger     (Inputs inputs);
+                unsigned printStatistics    (Inputs inputs);
+                unsigned setWaveParallel    (Inputs inputs);
+                unsigned setWaveExecutor    (Inputs inputs);
+                unsigned setWaveScheduling  (Inputs inputs);
+                unsigned lockMemory         (Inputs inputs);
+                unsigned setWaveDeadline    (Inputs inputs);
+                unsigned recordKeys         (Inputs inputs);
+                unsigned replayRecording    (Inputs inputs);
+                unsigned simulate           (Inputs inputs);
             private:
+                // Shared by the waves which ask for it, so it must outlive them.
+                std::unique_ptr<Executor> executor_;
+                // Kept until the end even when finished, as slots and waves may still point to them.
+                std::vector<std::unique_ptr<Comm::Recorder>> recorders_;
+                std::vector<std::unique_ptr<Comm::Replayer>> replayers_;
+
                 using BlackboardList = std::list<Comm::Blackboard>;
                 BlackboardList blackboards_;
                 std::unordered_map<std::string,std::pair<BrainWave, BlackboardList::iterator>> waves_;
+                // Watches the waves, so it must die before them.
+                std::unique_ptr<Watchdog> watchdog_;
+
+                // Time spent loading each module, in order of loading.
+                struct LoadTimes {
+                    std::string module;
+                    std::string wave;
+                    std::chrono::nanoseconds read;
+                    std::chrono::nanoseconds open;
+                    std::chrono::nanoseconds resolve;
+                    std::chrono::nanoseconds construct;
+                };
+                std::vector<LoadTimes> loadTimes_;
+
+                using ModuleMaker = std::function<BrainWave::Module(Comm::LocalBlackboardAdapter &, Comm::ExternalBlackboardAdapterMap &)>;
+
+                /**
+                 * @brief Constructs a module, adds it to a BrainWave and records its loading times.
+                 *
+                 * @param wave The name of the BrainWave.
+                 * @param make The function constructing the module.
+                 * @param times The times spent loading the module before constructing it.
+                 *
+                 * @return True if the module was added, false otherwise.
+                 */
+                bool addModule(const std::string & wave, const ModuleMaker & make, LoadTimes times);
+
+                /**
+                 * @brief Constructs the module of an opened library, and adds it to a BrainWave.
+                 *
+                 * @param wave The name of the BrainWave.
+                 * @param library The opened library, owned by the module afterwards.
+                 *
+                 * @return True if the module was added, false otherwise.
+                 */
+                bool addLibrary(const std::string & wave, const Modules::DynamicLibrary & library);
+
+                /**
+                 * @brief Constructs a module linked into the framework, and adds it to a BrainWave.
+                 *
+                 * @param wave The name of the BrainWave.
+                 * @param name The name of the module in the StaticModuleRegistry.
+                 *
+                 * @return True if the module was added, false otherwise.
+                 */
+                bool addStaticModule(const std::string & wave, const std::string & name);
+
+                /**
+                 * @brief Finds the module linked into the framework matching a library filename.
+                 *
+                 * @param moduleFilename The filename of the library, as libName.so, or just the name.
+                 *
+                 * @return The name of the module in the StaticModuleRegistry, empty if there is none.
+                 */
+                static std::string getStaticName(const std::string & moduleFilename);
+
+                /**
+                 * @brief Prints the loading times of modules.
+                 *
+                 * @param first The index of the first module to print.
+                 */
+                void printLoadTimes(size_t first) const;
 
                 /**
                  * @brief Unconditionally creates a BrainWave.
@@ -2,22 +2,48 @@
 #define NAO_FRAMEWORK_CORE_BRAIN_WAVE_HEADER_FILE
 
 #include <NaoFramework/Log/Loggable.hpp>
+#include <NaoFramework/Core/TimingStatistics.hpp>
+#include <NaoFramework/Core/WorkerPool.hpp>
+#include <NaoFramework/Core/Executor.hpp>
+#include <NaoFramework/Comm/Dependencies.hpp>
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <memory>
+#include <chrono>
+#include <functional>
 
 namespace NaoFramework {
     namespace Modules { class ModuleInterface; }
+    namespace Comm { class Trigger; class Replayer; }
     namespace Core {
         /**
          * @brief This class manages a single thread of execution and its modules.
          *
          * This class manages the execution of a single thread, which loops continuously
-         * over the modules added to it. In addition, all modules assigned to the 
+         * over the modules added to it. A BrainWave can be given a period, in which case
+         * each cycle starts at a fixed rate, and the thread sleeps between cycles. It can
+         * also be given a Trigger, in which case each cycle starts when the Trigger is
+         * notified, so that cycles follow the arrival of new data. The BrainWave times each
+         * module and each cycle, and keeps statistics about them. Its thread can be given a
+         * real-time policy and a set of CPUs, so that time-critical waves are not preempted
+         * by heavier ones. A BrainWave can also be given a deadline: cycles taking longer
+         * are counted together with their slowest module, and modules marked as skippable
+         * are left out of the following cycle to catch up. The BrainWave publishes a
+         * heartbeat, which a Watchdog can check to find out about modules which hang.
+         *
+         * Modules normally run one after the other in the order they were added. In parallel
+         * mode, modules are instead grouped in stages using the keys they registered on the
+         * local Blackboard: each module is placed in the stage after the last earlier module
+         * it depends on, and the modules of a stage run concurrently, either on a WorkerPool
+         * owned by the BrainWave or on an Executor shared with other BrainWaves. This
+         * keeps every provide before the requires that followed it. In addition, all modules assigned to the 
          * BrainWave are also owned by it, and are thus cleared once the BrainWave
          * is destroyed.
          */
@@ -25,6 +51,31 @@ namespace NaoFramework {
             public:
                 using Module = std::unique_ptr<Modules::ModuleInterface>;
 
+                /**
+                 * @brief This struct describes how the operating system schedules the thread of a BrainWave.
+                 */
+                struct Scheduling {
+                    enum Policy {
+                        Default,    // SCHED_OTHER, the priority is ignored.
+                        Fifo,       // SCHED_FIFO
+                        RoundRobin  // SCHED_RR
+                    };
+
+                    Policy policy;
+                    int priority;               // Real-time priority, from 1 to 99.
+                    std::vector<unsigned> cpus; // CPUs the thread may run on, empty for all.
+                };
+
+                /**
+                 * @brief This struct contains a snapshot of the progress of a BrainWave.
+                 */
+                struct Heartbeat {
+                    unsigned long cycles;                           // Cycles started so far.
+                    bool inCycle;                                   // Whether modules are running.
+                    std::chrono::steady_clock::time_point start;    // Start of the current cycle.
+                    std::string module;                             // Last module started in the current cycle.
+                };
+
                 /**
                  * @brief Basic constructor.
                  *
@@ -36,9 +87,9 @@ namespace NaoFramework {
                 /**
                  * @brief Move constructor.
                  *
-                 * The move constructor temporarily pauses the wave for transport,
-                 * as the internal thread uses the internal atomic flag in order
-                 * to stop, and after moving it would reference the wrong place.
+                 * The move constructor stops the thread of the moved wave, as it
+                 * references the moved object, and starts a new one if the moved
+                 * wave was running.
                  *
                  * @param wave The BrainWave that is being moved.
                  */
@@ -46,9 +97,9 @@ namespace NaoFramework {
                 /**
                  * @brief Move assigment operator.
                  *
-                 * The move assignment operator temporarily pauses the wave for transport,
-                 * as the internal thread uses the internal atomic flag in order
-                 * to stop, and after moving it would reference the wrong place.
+                 * The move assignment operator stops the threads of both waves, as
+                 * they reference their own objects, and starts a new one if the moved
+                 * wave was running.
                  *
                  * @param wave The BrainWave that is being moved.
                  *
@@ -59,8 +110,8 @@ namespace NaoFramework {
                 /**
                  * @brief This function adds a module to the BrainWave.
                  *
-                 * If the BrainWave is running, it will be stopped for insertion, and 
-                 * then restarted. As long as dependencies are correct this should not 
+                 * If the BrainWave is running, it will be paused at the end of its current
+                 * cycle for insertion, and then resumed. As long as dependencies are correct this should not 
                  * be a problem, as no Blackboard is touched. The new module is added 
                  * as the last entry of the current list of loaded modules, and will 
                  * be called last.
@@ -69,12 +120,47 @@ namespace NaoFramework {
                  */
                 void addModule(Module && module);
 
+                /**
+                 * @brief This function adds a module with known dependencies to the BrainWave.
+                 *
+                 * This works as addModule(Module&&), but in parallel mode the module can run
+                 * concurrently with modules it does not share keys with. Modules added without
+                 * dependencies are never run concurrently with other modules.
+                 *
+                 * @param module The module that is being acquired by the BrainWave.
+                 * @param dependencies The keys the module registered on the local Blackboard.
+                 */
+                void addModule(Module && module, const Comm::Dependencies & dependencies);
+
+                using ModuleUpdate = std::function<Comm::Dependencies(Modules::ModuleInterface &, const Comm::Dependencies *)>;
+
+                /**
+                 * @brief This function changes a module of the BrainWave in place.
+                 *
+                 * If the BrainWave is running, it is paused at the end of its current cycle, the
+                 * update is run, and then the BrainWave is resumed, even if the update throws.
+                 * Other BrainWaves are not affected. This is used to reload modules.
+                 *
+                 * @param module The name of the module.
+                 * @param update The function changing the module, which receives the module and its
+                 *               old dependencies, or nullptr if unknown, and returns its new ones.
+                 *
+                 * @return True if the module was found, false otherwise.
+                 */
+                bool updateModule(const std::string & module, const ModuleUpdate & update);
+
                 /**
                  * @brief This function starts the execution of the BrainWave.
+                 *
+                 * The thread is created the first time, and is resumed afterwards, so
+                 * that it keeps its scheduling and resuming is immediate.
                  */
                 void execute();
                 /**
                  * @brief This function stops the execution of the BrainWave.
+                 *
+                 * The thread finishes its current cycle, and then parks until the
+                 * BrainWave is executed again. This function returns once it has parked.
                  */
                 void pause();
                 /**
@@ -84,6 +170,241 @@ namespace NaoFramework {
                  */
                 bool isRunning() const;
 
+                /**
+                 * @brief This function runs a single cycle of the BrainWave on the calling thread.
+                 *
+                 * This is used to simulate waves: modules run one after the other even in
+                 * parallel mode, and deadlines are ignored, so that the cycle does the same
+                 * work on every run. Timing statistics are still recorded. The BrainWave must
+                 * be paused.
+                 *
+                 * @return True if the cycle was run, false if the BrainWave is running.
+                 */
+                bool simulateCycle();
+
+                /**
+                 * @brief This function sets the period of the BrainWave.
+                 *
+                 * Cycles are started on absolute deadlines spaced by the period, so that
+                 * the time taken by modules does not make the rate drift. If a cycle takes
+                 * longer than the period the overrun is counted and logged, and the next
+                 * cycle starts immediately, with deadlines realigned from then on.
+                 *
+                 * This can be called while the BrainWave is running, and takes effect
+                 * from the next cycle.
+                 *
+                 * @param period The period of a cycle, zero to run cycles back-to-back.
+                 */
+                void setPeriod(std::chrono::microseconds period);
+
+                /**
+                 * @brief This function returns the period of the BrainWave.
+                 *
+                 * @return The period of a cycle, zero if the BrainWave runs cycles back-to-back.
+                 */
+                std::chrono::microseconds getPeriod() const;
+
+                /**
+                 * @brief This function returns the number of cycles which took longer than the period.
+                 *
+                 * @return The number of overruns since construction.
+                 */
+                unsigned long getOverruns() const;
+
+                /**
+                 * @brief This function makes cycles start on notifications of a Trigger.
+                 *
+                 * Each cycle waits for a new notification before calling the modules. If a
+                 * period is set as well, it is counted from the start of each cycle, and
+                 * overruns are cycles which took longer than the period.
+                 *
+                 * This can be called while the BrainWave is running.
+                 *
+                 * @param trigger The Trigger to wait on, nullptr to stop waiting.
+                 */
+                void setTrigger(Comm::Trigger * trigger);
+
+                /**
+                 * @brief This function returns the Trigger the BrainWave waits on.
+                 *
+                 * @return The Trigger, nullptr if there is none.
+                 */
+                Comm::Trigger * getTrigger() const;
+
+                /**
+                 * @brief This function makes each cycle start by providing recorded data.
+                 *
+                 * The Replayer is called by the wave thread before the modules of each cycle.
+                 * While replaying, cycles do not wait for the Trigger, if any: the Trigger
+                 * usually follows a replayed key, which is only written by the Replayer.
+                 * This can be called while the BrainWave is running, but the Replayer must
+                 * outlive the BrainWave, as a cycle may have just started with it.
+                 *
+                 * @param replayer The Replayer to call, nullptr to stop replaying.
+                 */
+                void setReplayer(Comm::Replayer * replayer);
+
+                /**
+                 * @brief This function returns the Replayer called at the start of each cycle.
+                 *
+                 * @return The Replayer, nullptr if there is none.
+                 */
+                Comm::Replayer * getReplayer() const;
+
+                /**
+                 * @brief This function enables or disables parallel execution of modules.
+                 *
+                 * If the BrainWave is running, it will be stopped for the change, and
+                 * then restarted.
+                 *
+                 * @param workers The number of additional threads to use, zero to run modules sequentially.
+                 */
+                void setParallel(unsigned workers);
+
+                /**
+                 * @brief This function makes stages run on an Executor shared with other BrainWaves.
+                 *
+                 * Stages still run in order, but modules within a stage are submitted to the
+                 * Executor with the given priority, instead of to a WorkerPool owned by the
+                 * BrainWave. This replaces any WorkerPool set with setParallel().
+                 *
+                 * If the BrainWave is running, it will be stopped for the change, and
+                 * then restarted. The Executor must outlive the BrainWave, or be removed
+                 * before being destroyed.
+                 *
+                 * @param executor The Executor to use, nullptr to run modules sequentially.
+                 * @param priority The priority of the modules of this BrainWave.
+                 */
+                void setExecutor(Executor * executor, Executor::Priority priority = Executor::Normal);
+
+                /**
+                 * @brief This function returns the Executor the BrainWave runs stages on.
+                 *
+                 * @return The Executor, nullptr if there is none.
+                 */
+                Executor * getExecutor() const;
+
+                /**
+                 * @brief This function sets the deadline of each cycle of the BrainWave.
+                 *
+                 * Unlike the period, the deadline is only about the time spent running modules.
+                 * When a cycle misses the deadline the miss is counted, the slowest module of
+                 * the cycle is recorded and logged, and skippable modules are not run in the
+                 * next cycle.
+                 *
+                 * This can be called while the BrainWave is running, and takes effect
+                 * from the next cycle.
+                 *
+                 * @param deadline The maximum duration of a cycle, zero for none.
+                 */
+                void setDeadline(std::chrono::microseconds deadline);
+
+                /**
+                 * @brief This function returns the deadline of the BrainWave.
+                 *
+                 * @return The maximum duration of a cycle, zero if there is none.
+                 */
+                std::chrono::microseconds getDeadline() const;
+
+                /**
+                 * @brief This function returns the number of cycles which missed the deadline.
+                 *
+                 * @return The number of deadline misses since construction.
+                 */
+                unsigned long getDeadlineMisses() const;
+
+                /**
+                 * @brief This function returns the slowest module of the last cycle which missed the deadline.
+                 *
+                 * @return The name of the module, empty if no cycle missed the deadline.
+                 */
+                std::string getLastMissOffender() const;
+
+                /**
+                 * @brief This function sets whether a module can be skipped after a deadline miss.
+                 *
+                 * If the BrainWave is running, it will be stopped for the change, and
+                 * then restarted.
+                 *
+                 * @param module The name of the module.
+                 * @param skippable Whether the module can be skipped.
+                 *
+                 * @return True if the module was found, false otherwise.
+                 */
+                bool setSkippable(const std::string & module, bool skippable);
+
+                /**
+                 * @brief This function returns the current progress of the BrainWave.
+                 *
+                 * This can be called from any thread, and does not slow down the BrainWave.
+                 *
+                 * @return A snapshot of the progress of the BrainWave.
+                 */
+                Heartbeat getHeartbeat() const;
+
+                /**
+                 * @brief This function returns the counter of the cycles started by the BrainWave.
+                 *
+                 * This is used to tag data provided during a cycle with its number.
+                 *
+                 * @return The cycle counter.
+                 */
+                const std::atomic<unsigned long> & getCycles() const;
+
+                /**
+                 * @brief This function sets the scheduling of the thread of the BrainWave.
+                 *
+                 * The scheduling is applied by the thread itself as soon as it starts, and by the
+                 * threads of its WorkerPool in parallel mode, which run its modules too. Threads of
+                 * a shared Executor are not affected. Real-time policies usually need privileges:
+                 * if the policy or the affinity cannot be applied a warning is logged, and the
+                 * thread runs with what it already had.
+                 *
+                 * If the BrainWave is running, it will be stopped for the change, and
+                 * then restarted.
+                 *
+                 * @param scheduling The scheduling of the thread.
+                 */
+                void setScheduling(const Scheduling & scheduling);
+
+                /**
+                 * @brief This function returns the scheduling of the thread of the BrainWave.
+                 *
+                 * @return The scheduling requested for the thread.
+                 */
+                const Scheduling & getScheduling() const;
+
+                /**
+                 * @brief This function returns the stages in which modules are run in parallel mode.
+                 *
+                 * @return The names of the modules of each stage.
+                 */
+                std::vector<std::vector<std::string>> getStages() const;
+
+                /**
+                 * @brief This function returns the timing statistics of each module.
+                 *
+                 * @return The name and statistics of each module, in order of execution.
+                 */
+                std::vector<std::pair<std::string, TimingStatistics::Summary>> getModuleStatistics() const;
+
+                /**
+                 * @brief This function returns the timing statistics of whole cycles.
+                 *
+                 * This only includes the time spent in modules, not waiting or sleeping.
+                 *
+                 * @return The statistics of cycles.
+                 */
+                TimingStatistics::Summary getCycleStatistics() const;
+
+                /**
+                 * @brief This function discards all timing statistics.
+                 *
+                 * If the BrainWave is running, statistics are discarded by its thread
+                 * at the start of the next cycle.
+                 */
+                void resetStatistics();
+
                 /**
                  * @brief This function returns the name of the BrainWave.
                  *
@@ -96,9 +417,61 @@ namespace NaoFramework {
                 std::vector<Module> modules_;
                 std::unordered_map<std::string, size_t> indices_;
 
+                // Dependencies of each module, nullptr when unknown.
+                std::vector<std::unique_ptr<Comm::Dependencies>> dependencies_;
+                // Indices of the modules that can run together, in order.
+                std::vector<std::vector<size_t>> stages_;
+                std::unique_ptr<WorkerPool> pool_;
+                Executor * executor_;
+                Executor::Priority priority_;
+
+                Scheduling scheduling_;
+
+                std::atomic<std::chrono::microseconds::rep> deadline_;
+                std::atomic<unsigned long> misses_;
+                std::atomic<long> lastMiss_;            // Index of the slowest module of the last miss, -1 if none.
+                std::vector<char> skippable_;           // Not vector<bool>, as it's read by many threads.
+                std::vector<TimingStatistics::Duration> lastDurations_;
+                bool catchingUp_;                       // Only written by the wave thread, between stages.
+
+                // Heartbeat, only written by the wave thread and without locks. The start is
+                // in nanoseconds since the clock epoch, the module is an index, -1 if none.
+                std::atomic<unsigned long> cycles_;
+                std::atomic<std::chrono::nanoseconds::rep> cycleStart_;
+                std::atomic<bool> inCycle_;
+                std::atomic<long> currentModule_;
+                // Names of the modules, for the heartbeat, as other threads read it while
+                // modules_ may change. Only changed under namesMutex_.
+                std::vector<std::string> names_;
+                mutable std::mutex namesMutex_;
+
+                // The thread is created once, and parks at the end of a cycle when
+                // running_ is false. The other flags are protected by controlMutex_.
                 std::atomic<bool> running_;
+                bool parked_;
+                bool quitting_;
+                bool rescheduled_;
+                std::mutex controlMutex_;
+                std::condition_variable control_;
+                std::atomic<std::chrono::microseconds::rep> period_;
+                std::atomic<unsigned long> overruns_;
+                std::atomic<Comm::Trigger*> trigger_;
+                std::atomic<Comm::Replayer*> replayer_;
+
+                // Statistics are only written by the wave thread.
+                std::deque<TimingStatistics> moduleStatistics_;
+                std::unique_ptr<TimingStatistics> cycleStatistics_;
+                std::atomic<bool> resetStatistics_;
 
                 void launchWave();
+                void runCycle(bool simulated);
+                bool park();
+                void stop();
+                void applyScheduling();
+                void makePool(unsigned workers);
+                void runModule(size_t i);
+                void recordMiss(TimingStatistics::Duration cycle);
+                void updateStages();
                 std::thread wave_;
         };
     } // Core
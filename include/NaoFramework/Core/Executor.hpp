@@ -0,0 +1,109 @@
+#ifndef NAO_FRAMEWORK_CORE_EXECUTOR_HEADER_FILE
+#define NAO_FRAMEWORK_CORE_EXECUTOR_HEADER_FILE
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Core {
+        /**
+         * @brief This class runs batches of tasks from many BrainWaves on a shared set of threads.
+         *
+         * Each worker thread owns a queue for each priority. When a batch is submitted, the
+         * caller spreads tokens for it among the workers' queues, and then starts running the
+         * batch's tasks itself. Workers holding a token join the batch, and claim tasks until
+         * none are left. Idle workers steal tokens from the other workers' queues, and tokens
+         * of higher priority are always taken first, so that a wave with heavy modules can use
+         * the threads left idle by other waves without delaying more important waves.
+         *
+         * As with WorkerPool, submitting a batch does not allocate once the queues have grown.
+         * Unlike WorkerPool, any number of threads can submit batches concurrently.
+         */
+        class Executor {
+            public:
+                using Task = std::function<void(size_t)>;
+
+                enum Priority {
+                    High,
+                    Normal,
+                    Low,
+                    PrioritiesNumber
+                };
+
+                /**
+                 * @brief Basic constructor, starts the worker threads.
+                 *
+                 * @param workers The number of threads to start.
+                 */
+                Executor(unsigned workers);
+
+                /**
+                 * @brief Basic destructor, stops and joins the worker threads.
+                 *
+                 * No batch must be running when the Executor is destroyed.
+                 */
+                ~Executor();
+
+                Executor(const Executor &) = delete;
+                Executor & operator=(const Executor &) = delete;
+
+                /**
+                 * @brief This function runs a batch of tasks, and returns once all are done.
+                 *
+                 * The caller takes part in running the batch.
+                 *
+                 * @param count The number of tasks.
+                 * @param task The function to call with the index of each task.
+                 * @param priority The priority of the tasks.
+                 */
+                void run(size_t count, const Task & task, Priority priority);
+
+                /**
+                 * @brief This function returns the number of worker threads.
+                 *
+                 * @return The number of worker threads.
+                 */
+                unsigned getWorkers() const;
+
+            private:
+                struct Batch {
+                    const Task * task;
+                    size_t count;
+                    std::atomic<size_t> next;
+                    std::atomic<unsigned> active;   // Workers which took a token of this batch.
+
+                    std::mutex mutex;
+                    std::condition_variable done;
+                };
+
+                struct Worker {
+                    std::mutex mutex;
+                    std::deque<Batch*> queues[PrioritiesNumber];
+                };
+
+                std::vector<std::unique_ptr<Worker>> workers_;
+                std::vector<std::thread> threads_;
+                std::atomic<unsigned> nextWorker_;
+
+                std::atomic<size_t> queued_;
+                std::mutex sleepMutex_;
+                std::condition_variable wake_;
+                bool quitting_;
+
+                void work(unsigned id);
+                Batch * pop(unsigned id);
+                void join(Batch * batch);
+                void revoke(Batch * batch);
+                static void runTasks(Batch * batch);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef NAO_FRAMEWORK_CORE_TIMING_STATISTICS_HEADER_FILE
+#define NAO_FRAMEWORK_CORE_TIMING_STATISTICS_HEADER_FILE
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace NaoFramework {
+    namespace Core {
+        /**
+         * @brief This class collects statistics about a series of durations.
+         *
+         * Durations are stored in a preallocated histogram with logarithmic buckets, so
+         * recording never allocates and percentiles are accurate to about 20%. Minimum,
+         * maximum and mean are exact.
+         *
+         * A single thread may record durations, while any thread can read a summary at
+         * any time. Summaries read while recording happens may be slightly inconsistent,
+         * but never invalid.
+         */
+        class TimingStatistics {
+            public:
+                using Duration = std::chrono::nanoseconds;
+
+                /**
+                 * @brief This struct contains a snapshot of the collected statistics.
+                 *
+                 * All durations are zero if no duration has been recorded.
+                 */
+                struct Summary {
+                    uint64_t count;
+                    Duration min;
+                    Duration mean;
+                    Duration max;
+                    Duration p50;
+                    Duration p90;
+                    Duration p99;
+                };
+
+                /**
+                 * @brief Basic constructor.
+                 */
+                TimingStatistics();
+
+                TimingStatistics(const TimingStatistics &) = delete;
+                TimingStatistics & operator=(const TimingStatistics &) = delete;
+
+                /**
+                 * @brief This function records a single duration.
+                 *
+                 * This function must only be called by a single thread.
+                 *
+                 * @param d The duration to record.
+                 */
+                void record(Duration d);
+
+                /**
+                 * @brief This function computes a summary of all recorded durations.
+                 *
+                 * @return A summary of the durations.
+                 */
+                Summary summarize() const;
+
+                /**
+                 * @brief This function discards all recorded durations.
+                 *
+                 * This function must only be called by the thread recording durations,
+                 * or while no thread is recording.
+                 */
+                void reset();
+
+            private:
+                // 8 exact buckets for tiny values, then 4 buckets per power of two, up to 2^40 ns.
+                static constexpr unsigned SubBuckets = 4;
+                static constexpr unsigned MaxExponent = 40;
+                static constexpr unsigned BucketsNumber = 8 + (MaxExponent - 3) * SubBuckets;
+
+                // Only the recording thread writes to these, so relaxed loads and stores
+                // are enough and no atomic read-modify-write is ever needed.
+                std::atomic<uint64_t> count_;
+                std::atomic<uint64_t> sum_;
+                std::atomic<uint64_t> min_;
+                std::atomic<uint64_t> max_;
+                std::array<std::atomic<uint64_t>, BucketsNumber> buckets_;
+
+                static unsigned getBucket(uint64_t value);
+                static uint64_t getBucketValue(unsigned bucket);
+                Duration getPercentile(uint64_t count, double percentile) const;
+        };
+    }
+}
+
+#endif
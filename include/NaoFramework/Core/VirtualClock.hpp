@@ -0,0 +1,64 @@
+#ifndef NAO_FRAMEWORK_CORE_VIRTUAL_CLOCK_HEADER_FILE
+#define NAO_FRAMEWORK_CORE_VIRTUAL_CLOCK_HEADER_FILE
+
+#include <atomic>
+#include <chrono>
+
+namespace NaoFramework {
+    namespace Core {
+        /**
+         * @brief This class is the clock modules should read the time from.
+         *
+         * It follows std::chrono::steady_clock, except while the Brain simulates waves.
+         * Then time only moves when the simulation sets it to the start of each simulated
+         * cycle, starting from the epoch, so that modules see the same times on every run
+         * however fast cycles actually run. It can be used as any std::chrono clock.
+         */
+        class VirtualClock {
+            public:
+                using duration   = std::chrono::nanoseconds;
+                using rep        = duration::rep;
+                using period     = duration::period;
+                using time_point = std::chrono::time_point<VirtualClock>;
+                // Time jumps when simulations start and end.
+                static constexpr bool is_steady = false;
+
+                /**
+                 * @brief This function returns the current time.
+                 *
+                 * @return The simulated time during simulations, the steady time otherwise.
+                 */
+                static time_point now();
+
+                /**
+                 * @brief This function checks whether a simulation is running.
+                 *
+                 * @return True if time is simulated, false otherwise.
+                 */
+                static bool isSimulated();
+
+                /**
+                 * @brief This function starts simulating time, from the epoch.
+                 */
+                static void startSimulation();
+
+                /**
+                 * @brief This function sets the simulated time.
+                 *
+                 * @param time The new time, which should not be earlier than the current one.
+                 */
+                static void advance(time_point time);
+
+                /**
+                 * @brief This function goes back to the steady time.
+                 */
+                static void stopSimulation();
+
+            private:
+                static std::atomic<bool> simulated_;
+                static std::atomic<rep> now_;
+        };
+    }
+}
+
+#endif
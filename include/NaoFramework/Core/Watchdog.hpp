@@ -0,0 +1,70 @@
+#ifndef NAO_FRAMEWORK_CORE_WATCHDOG_HEADER_FILE
+#define NAO_FRAMEWORK_CORE_WATCHDOG_HEADER_FILE
+
+#include <NaoFramework/Log/Loggable.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Core {
+        class BrainWave;
+        /**
+         * @brief This class checks periodically that BrainWaves are not stuck.
+         *
+         * The Watchdog runs its own thread, which reads the heartbeat of each watched BrainWave
+         * every half of the shortest deadline among them, so that a stuck cycle is caught at most
+         * half a deadline late. When a cycle with a deadline has been running for longer than the
+         * deadline, a warning naming the module being run is logged, once per cycle. As reading
+         * heartbeats does not stop the waves, watched BrainWaves are not slowed down.
+         */
+        class Watchdog : public Log::Loggable {
+            public:
+                /**
+                 * @brief Basic constructor, starts the thread.
+                 */
+                Watchdog();
+
+                /**
+                 * @brief Basic destructor, stops and joins the thread.
+                 */
+                ~Watchdog();
+
+                Watchdog(const Watchdog &) = delete;
+                Watchdog & operator=(const Watchdog &) = delete;
+
+                /**
+                 * @brief This function adds a BrainWave to the ones being checked.
+                 *
+                 * The BrainWave must outlive the Watchdog, and must not be moved. This must be
+                 * called again when the deadline of the BrainWave changes, so that the time
+                 * between checks follows it.
+                 *
+                 * @param wave The BrainWave to check.
+                 */
+                void watch(const BrainWave & wave);
+
+            private:
+                struct Watched {
+                    const BrainWave * wave;
+                    unsigned long reported; // Last cycle we warned about.
+                };
+
+                std::vector<Watched> waves_;
+
+                bool quitting_;
+                std::mutex mutex_;
+                std::condition_variable condition_;
+                std::thread thread_;
+
+                void run();
+                void check(Watched & watched);
+                std::chrono::microseconds getInterval() const;
+        };
+    }
+}
+
+#endif
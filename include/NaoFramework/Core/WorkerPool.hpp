@@ -0,0 +1,81 @@
+#ifndef NAO_FRAMEWORK_CORE_WORKER_POOL_HEADER_FILE
+#define NAO_FRAMEWORK_CORE_WORKER_POOL_HEADER_FILE
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NaoFramework {
+    namespace Core {
+        /**
+         * @brief This class runs batches of independent tasks on a fixed set of threads.
+         *
+         * The pool works as a parallel for: a batch is a number of tasks identified by
+         * their index, which are picked up by the worker threads and by the caller itself
+         * until none are left. Running a batch does not allocate.
+         *
+         * Only one batch can run at any given time, so a pool should be used by a single thread.
+         */
+        class WorkerPool {
+            public:
+                using Task = std::function<void(size_t)>;
+
+                /**
+                 * @brief Basic constructor, starts the worker threads.
+                 *
+                 * @param workers The number of threads to start, in addition to the caller of run().
+                 * @param setup The function each worker thread calls once when it starts, or nullptr.
+                 */
+                WorkerPool(unsigned workers, const std::function<void()> & setup = nullptr);
+
+                /**
+                 * @brief Basic destructor, stops and joins the worker threads.
+                 */
+                ~WorkerPool();
+
+                WorkerPool(const WorkerPool &) = delete;
+                WorkerPool & operator=(const WorkerPool &) = delete;
+
+                /**
+                 * @brief This function runs a batch of tasks, and returns once all are done.
+                 *
+                 * @param count The number of tasks.
+                 * @param task The function to call with the index of each task.
+                 */
+                void run(size_t count, const Task & task);
+
+                /**
+                 * @brief This function returns the number of worker threads.
+                 *
+                 * @return The number of worker threads.
+                 */
+                unsigned getWorkers() const;
+
+            private:
+                std::vector<std::thread> workers_;
+
+                std::mutex mutex_;
+                std::condition_variable start_;
+                std::condition_variable done_;
+
+                // All protected by mutex_
+                unsigned long batch_;
+                bool quitting_;
+                unsigned active_;
+
+                // Current batch
+                const Task * task_;
+                size_t count_;
+                std::atomic<size_t> next_;
+
+                void work();
+                void runTasks();
+        };
+    }
+}
+
+#endif
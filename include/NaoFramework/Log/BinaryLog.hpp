@@ -0,0 +1,134 @@
+#ifndef NAO_FRAMEWORK_LOG_BINARY_LOG_HEADER_FILE
+#define NAO_FRAMEWORK_LOG_BINARY_LOG_HEADER_FILE
+
+#include <NaoFramework/Log/Types.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace NaoFramework {
+    namespace Log {
+        /*
+         * The binary log is a single file, starting with Magic and followed by entries.
+         * Each entry starts with its EntryType byte. Numbers are in the byte order of the
+         * machine which wrote the log.
+         *
+         *  ClientEntry:  uint16 id, uint32 size, name
+         *  FormatEntry:  uint32 id, uint32 size, format string
+         *  MessageEntry: int64 nanoseconds since epoch, uint16 client id, uint8 priority,
+         *                uint32 format id, uint32 size, arguments
+         *
+         * Clients and formats are defined once, before the first message which uses them.
+         * Each argument is its ArgumentType byte followed by its value: 8 bytes for
+         * numbers, or uint32 size and bytes for strings.
+         */
+        namespace BinaryLog {
+            constexpr char Magic[8] = { 'N', 'A', 'O', 'L', 'O', 'G', '1', '\0' };
+
+            enum EntryType : uint8_t {
+                ClientEntry = 1,
+                FormatEntry,
+                MessageEntry
+            };
+
+            enum ArgumentType : uint8_t {
+                SignedArgument = 1,
+                UnsignedArgument,
+                FloatingArgument,
+                StringArgument
+            };
+
+            template <class T>
+            void put(std::string & buffer, T value) {
+                buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            inline void putString(std::string & buffer, const char * data, size_t size) {
+                put<uint32_t>(buffer, size);
+                buffer.append(data, size);
+            }
+
+            template <class T>
+            bool get(const char *& data, const char * end, T & value) {
+                if ( static_cast<size_t>(end - data) < sizeof(T) ) return false;
+                std::memcpy(&value, data, sizeof(T));
+                data += sizeof(T);
+                return true;
+            }
+
+            inline bool getString(const char *& data, const char * end, std::string & value) {
+                uint32_t size;
+                if ( !get(data, end, size) || static_cast<size_t>(end - data) < size ) return false;
+                value.assign(data, size);
+                data += size;
+                return true;
+            }
+
+            // Encoding is overloaded on the argument type; anything else must be converted by the caller.
+            template <class T>
+            typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+            encode(std::string & buffer, T value) {
+                put<uint8_t>(buffer, SignedArgument);
+                put<int64_t>(buffer, value);
+            }
+
+            template <class T>
+            typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+            encode(std::string & buffer, T value) {
+                put<uint8_t>(buffer, UnsignedArgument);
+                put<uint64_t>(buffer, value);
+            }
+
+            template <class T>
+            typename std::enable_if<std::is_floating_point<T>::value>::type
+            encode(std::string & buffer, T value) {
+                put<uint8_t>(buffer, FloatingArgument);
+                put<double>(buffer, value);
+            }
+
+            inline void encode(std::string & buffer, const char * value) {
+                put<uint8_t>(buffer, StringArgument);
+                putString(buffer, value, std::strlen(value));
+            }
+
+            inline void encode(std::string & buffer, const std::string & value) {
+                put<uint8_t>(buffer, StringArgument);
+                putString(buffer, value.data(), value.size());
+            }
+
+            inline void encodeAll(std::string &) {}
+
+            template <class T, class... Args>
+            void encodeAll(std::string & buffer, const T & value, const Args &... args) {
+                encode(buffer, value);
+                encodeAll(buffer, args...);
+            }
+
+            /**
+             * @brief This function formats encoded arguments with a Boost.Format string.
+             *
+             * Malformed formats or arguments do not throw, the format is returned with a
+             * note instead, so that a bad message never loses the others.
+             *
+             * @param format The format string.
+             * @param arguments The encoded arguments.
+             *
+             * @return The formatted message.
+             */
+            std::string format(const std::string & format, const std::string & arguments);
+
+            /**
+             * @brief This function returns the name of a priority, as written in text logs.
+             *
+             * @param priority The priority.
+             *
+             * @return The name of the priority.
+             */
+            const char * getPriorityName(MessagePriority priority);
+        }
+    }
+}
+
+#endif
@@ -2,17 +2,58 @@
 #define NAO_FRAMEWORK_LOG_LOGGER_HEADER_FILE
 
 #include <NaoFramework/Log/Types.hpp>
+#include <NaoFramework/Log/BinaryLog.hpp>
 
 #include <string>
+#include <memory>
 
 namespace NaoFramework {
     namespace Log {
+        enum LogFormat {
+            TextFormat,     // A text file for each client.
+            SharedFormat,   // A single text file for all clients, each message tagged with its client.
+            BinaryFormat    // A single binary file for all clients, see BinaryLog.hpp.
+        };
+
         /**
          * @brief This function initializes the log backend. It should always be called at startup.
          *
+         * In shared and binary formats, all messages go to a single file, which the
+         * log_decoder tool can split by client. Binary logs also leave formatting
+         * to the tool.
+         *
          * @param folder This names the folder that will hold all logged records.
+         * @param format The format of the logged records.
+         */
+        void init       (const std::string & folder = "log", LogFormat format = TextFormat);
+
+        /**
+         * @brief This class identifies the sink of a client for the log writer.
+         *
+         * Clients which log often should create their channel once, so that logging
+         * through it does not build anything for each message.
+         */
+        class Channel;
+        using ChannelPointer = std::shared_ptr<Channel>;
+
+        /**
+         * @brief This function sets the minimum priority of logged messages.
+         *
+         * Messages with lower priority are discarded before being queued. This can be
+         * changed at any time, from any thread.
+         *
+         * @param priority The lowest priority to log.
+         */
+        void setLevel   (MessagePriority priority);
+
+        /**
+         * @brief This function checks whether messages of a given priority are logged.
+         *
+         * @param priority The priority to check.
+         *
+         * @return True if messages with this priority are logged, false otherwise.
          */
-        void init       (const std::string & folder = "log");
+        bool isEnabled  (MessagePriority priority);
 
         /**
          * @brief This function creates a new sink.
@@ -30,10 +71,79 @@ namespace NaoFramework {
         bool makeSink   (const std::string & client, const std::string & subfolder);
         void removeSink (const std::string & client, const std::string & subfolder);
 
+        /**
+         * @brief This function creates a channel for a client.
+         *
+         * @param client The name of the client.
+         * @param subfolder The folder of the client.
+         *
+         * @return The new channel.
+         */
+        ChannelPointer makeChannel(const std::string & client, const std::string & subfolder);
+
+        /**
+         * @brief This function logs a message for a client.
+         *
+         * The message is queued, and written to the sink by a background thread, so
+         * that this function never waits for the disk. Each thread has its own queue,
+         * so threads never wait for each other either. If a thread logs faster than
+         * messages can be written, its messages are dropped, and the drop is logged.
+         *
+         * @param client The name of the client.
+         * @param subfolder The folder of the client.
+         * @param message The message to log.
+         * @param priority The priority of the message.
+         */
         void log        (const std::string & client, 
                          const std::string & subfolder, 
                          const std::string & message, 
                          MessagePriority priority = Info);
+
+        /**
+         * @brief This function logs a message through a channel.
+         *
+         * This works as the other overload, but does not need to build the channel.
+         *
+         * @param channel The channel of the client.
+         * @param message The message to log.
+         * @param priority The priority of the message.
+         */
+        void log        (const ChannelPointer & channel,
+                         const std::string & message,
+                         MessagePriority priority = Info);
+
+        void logEncoded (const ChannelPointer & channel,
+                         MessagePriority priority,
+                         const char * format,
+                         std::string && arguments);
+
+        /**
+         * @brief This function logs a message for a client, leaving formatting to the writer.
+         *
+         * Arguments are only copied into the queue, and formatted with Boost.Format by the
+         * background thread, or by the decoder when logging in binary format. Only the
+         * address of the format is queued, so it must be a string literal, which is why
+         * it is taken as an array.
+         *
+         * @param channel The channel of the client.
+         * @param priority The priority of the message.
+         * @param format The Boost.Format string, a literal.
+         * @param args Numbers and strings to format.
+         */
+        template <size_t N, class... Args>
+        void logf       (const ChannelPointer & channel,
+                         MessagePriority priority,
+                         const char (&format)[N],
+                         const Args &... args) {
+            std::string arguments;
+            BinaryLog::encodeAll(arguments, args...);
+            logEncoded(channel, priority, format, std::move(arguments));
+        }
+
+        /**
+         * @brief This function waits until all messages logged before the call have been written.
+         */
+        void flush      ();
     }
 }
 
@@ -1,10 +1,41 @@
 #ifndef NAO_FRAMEWORK_LOG_LOGGABLE_HEADER_FILE
 #define NAO_FRAMEWORK_LOG_LOGGABLE_HEADER_FILE
 
-#include <NaoFramework/Log/Types.hpp>
+#include <NaoFramework/Log/Frontend.hpp>
 
 #include <string>
 
+// Messages with lower priority are removed at compile time by the macros below.
+#ifndef NAO_LOG_MINIMUM_PRIORITY
+#ifdef NAO_DEBUG
+#define NAO_LOG_MINIMUM_PRIORITY NaoFramework::Log::Trace
+#else
+#define NAO_LOG_MINIMUM_PRIORITY NaoFramework::Log::Info
+#endif
+#endif
+
+/**
+ * @brief This macro logs a message from a Loggable, building it only if it is going to be logged.
+ *
+ * The message expression is not evaluated when its priority is below NAO_LOG_MINIMUM_PRIORITY,
+ * which by default drops Trace and Debug messages in release builds, or below the level set
+ * with Log::setLevel.
+ */
+#define NAO_LOG(priority, message) \
+    do { \
+        if ( (priority) >= NAO_LOG_MINIMUM_PRIORITY && NaoFramework::Log::isEnabled(priority) ) \
+            this->log((message), (priority)); \
+    } while (0)
+
+/**
+ * @brief This macro is the same as NAO_LOG, but takes a format and arguments as Loggable::logf.
+ */
+#define NAO_LOGF(priority, ...) \
+    do { \
+        if ( (priority) >= NAO_LOG_MINIMUM_PRIORITY && NaoFramework::Log::isEnabled(priority) ) \
+            this->logf((priority), __VA_ARGS__); \
+    } while (0)
+
 namespace NaoFramework {
     namespace Log {
         /**
@@ -23,7 +54,7 @@ namespace NaoFramework {
         class Loggable {
             public:
                 /**
-                 * @brief Basic constructor, sets up a new sink.
+                 * @brief Basic constructor, sets up a new sink and the channel to it.
                  *
                  * This constructor creates a new sink, situated in folder 'folder' 
                  * and in file 'name' within the main logging folder setup during
@@ -70,9 +101,24 @@ namespace NaoFramework {
                  * @param priority The priority of the message.
                  */
                 void log(const std::string & message, MessagePriority priority = Info);
+
+                /**
+                 * @brief This function logs a message to the sink associated with this object, leaving formatting to the writer.
+                 *
+                 * See Log::logf.
+                 *
+                 * @param priority The priority of the message.
+                 * @param format The Boost.Format string, a literal.
+                 * @param args Numbers and strings to format.
+                 */
+                template <size_t N, class... Args>
+                void logf(MessagePriority priority, const char (&format)[N], const Args &... args) {
+                    NaoFramework::Log::logf(channel_, priority, format, args...);
+                }
             private:
                 std::string name_;
                 std::string folder_;
+                ChannelPointer channel_;    // Built once, so that logging only queues messages.
         };
     }
 }
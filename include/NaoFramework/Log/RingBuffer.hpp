@@ -0,0 +1,87 @@
+#ifndef NAO_FRAMEWORK_LOG_RING_BUFFER_HEADER_FILE
+#define NAO_FRAMEWORK_LOG_RING_BUFFER_HEADER_FILE
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+
+namespace NaoFramework {
+    namespace Log {
+        /**
+         * @brief This class is a fixed size queue between a single producer and a single consumer.
+         *
+         * Neither side ever locks or waits: pushing into a full buffer fails, and popping
+         * from an empty buffer fails. Elements are moved in and out, so that slots keep
+         * whatever memory the moved-from elements leave behind.
+         *
+         * @tparam T The type of the elements.
+         * @tparam Capacity The maximum number of elements, a power of two.
+         */
+        template <class T, size_t Capacity>
+        class RingBuffer {
+            static_assert(Capacity && !(Capacity & (Capacity - 1)), "RingBuffer capacity must be a power of two.");
+
+            public:
+                /**
+                 * @brief Basic constructor.
+                 */
+                RingBuffer() : head_(0), tail_(0) {}
+
+                RingBuffer(const RingBuffer &) = delete;
+                RingBuffer & operator=(const RingBuffer &) = delete;
+
+                /**
+                 * @brief This function adds an element to the buffer.
+                 *
+                 * This function must only be called by the producer.
+                 *
+                 * @param element The element to move into the buffer.
+                 *
+                 * @return True if the element was added, false if the buffer was full.
+                 */
+                bool push(T && element) {
+                    auto tail = tail_.load(std::memory_order_relaxed);
+                    if ( tail - head_.load(std::memory_order_acquire) == Capacity ) return false;
+
+                    elements_[tail & (Capacity - 1)] = std::move(element);
+                    tail_.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+
+                /**
+                 * @brief This function removes the oldest element from the buffer.
+                 *
+                 * This function must only be called by the consumer.
+                 *
+                 * @param element Where to move the element.
+                 *
+                 * @return True if an element was removed, false if the buffer was empty.
+                 */
+                bool pop(T & element) {
+                    auto head = head_.load(std::memory_order_relaxed);
+                    if ( head == tail_.load(std::memory_order_acquire) ) return false;
+
+                    element = std::move(elements_[head & (Capacity - 1)]);
+                    head_.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+
+                /**
+                 * @brief This function checks whether the buffer is empty.
+                 *
+                 * @return True if the buffer was empty when checked, false otherwise.
+                 */
+                bool empty() const {
+                    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+                }
+
+            private:
+                std::array<T, Capacity> elements_;
+                // On separate cache lines, as each is written by a different thread.
+                alignas(64) std::atomic<size_t> head_;
+                alignas(64) std::atomic<size_t> tail_;
+        };
+    }
+}
+
+#endif
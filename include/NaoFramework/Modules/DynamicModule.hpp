@@ -4,12 +4,61 @@
 #include <NaoFramework/Modules/DynamicModuleInterface.hpp>
 
 #include <string>
+#include <vector>
 #include <memory>
+#include <chrono>
+#include <functional>
 
 namespace NaoFramework {
     namespace Modules {
         class DynamicModule;
 
+        /**
+         * @brief This struct holds a shared library containing a module, which has been opened but not yet constructed.
+         *
+         * Opening a library does not touch any Blackboard, so many libraries can be opened
+         * concurrently, while constructing modules must be done one at a time.
+         */
+        struct DynamicLibrary {
+            std::string filename;
+            void * dllModule;
+            dynamicModuleFactory * factory;
+            dynamicModuleDump * deleter;
+
+            std::chrono::nanoseconds readTime;      // Reading the file into the page cache.
+            std::chrono::nanoseconds openTime;      // Spent in dlopen(), mostly relocations.
+            std::chrono::nanoseconds resolveTime;   // Spent in dlsym().
+        };
+
+        /**
+         * @brief This function opens a shared library containing a module, without constructing the module.
+         *
+         * The file is read fully before calling dlopen(), so that when opening many libraries
+         * at once the disk reads overlap, while dlopen() itself is serialized by the loader.
+         * This function can be called by many threads at the same time.
+         *
+         * @param moduleFilename The name of the shared library containing the module.
+         *
+         * @return The opened library.
+         * @throws If anything goes wrong, this function will throw an std::runtime_error.
+         */
+        DynamicLibrary openDynamicModule(const std::string & moduleFilename);
+
+        /**
+         * @brief This function constructs the module of an opened library and wraps it into a DynamicModule.
+         *
+         * The wrapper takes ownership of the library. If the module cannot be constructed, the
+         * library is closed.
+         *
+         * @param library The opened library.
+         * @param mainComm The adapter for the module's BrainWave.
+         * @param externalComm The adapter for all other BrainWaves.
+         *
+         * @return A pointer to the wrapper of the loaded module.
+         * @throws If anything goes wrong, this function will throw an std::runtime_error.
+         */
+        std::unique_ptr<DynamicModule> makeDynamicModule(const DynamicLibrary & library, Comm::LocalBlackboardAdapter & mainComm, Comm::ExternalBlackboardAdapterMap & externalComm);
+
         /**
          * @brief This function loads a module from a dynamic library and wraps it into a DynamicModule.
          *
@@ -57,21 +106,60 @@ namespace NaoFramework {
                  * @brief This function rerouts callers to the execute() method of the wrapped module.
                  */
                 virtual void execute();
+
+                /**
+                 * @brief This function replaces the wrapped module with a new build of it.
+                 *
+                 * The shared library is copied to a temporary file before being loaded, so that
+                 * a library with the same filename is loaded anew rather than shared. The current
+                 * module is deleted before the new one is constructed, so that it releases its
+                 * resources and the new one can register to the Blackboards again. The new module
+                 * must have the same name as the old one.
+                 *
+                 * The old library stays loaded until the wrapper is destroyed, since Blackboard
+                 * slots may have been created by its code and may still be in use.
+                 *
+                 * If the new module cannot be loaded, the old one is constructed again from its
+                 * library, and the error is thrown. The new module may have registered keys
+                 * before failing, so rollback is called first to release them.
+                 *
+                 * @param moduleFilename The name of the shared library containing the new module.
+                 * @param mainComm The adapter for the module's BrainWave.
+                 * @param externalComm The adapter for all other BrainWaves.
+                 * @param rollback The function undoing the registrations of a failed new module, or nullptr.
+                 *
+                 * @throws If anything goes wrong, this function will throw an std::runtime_error.
+                 */
+                void reload(const std::string & moduleFilename, Comm::LocalBlackboardAdapter & mainComm, Comm::ExternalBlackboardAdapterMap & externalComm,
+                            const std::function<void()> & rollback = nullptr);
+
+                /**
+                 * @brief This function returns the filename of the shared library containing the module.
+                 *
+                 * @return The filename the module was last loaded from.
+                 */
+                const std::string & getFilename() const;
             private:
+                std::string filename_;
                 void * dllModule_;
-                DynamicModuleInterface * module_;   // This is a class
-                dynamicModuleDump * moduleDeleter_; // This is a function
+                DynamicModuleInterface * module_;       // This is a class
+                dynamicModuleFactory * moduleFactory_;  // This is a function
+                dynamicModuleDump * moduleDeleter_;     // This is a function
+                std::vector<void *> retiredModules_;    // Libraries of reloaded modules.
 
                 /**
                  * @brief Basic constructor.
                  *
                  * @param name The name of the wrapper.
+                 * @param filename The name of the shared library.
                  * @param dllModule A pointer to the shared library memory location.
                  * @param module A pointer to an allocated instance of the loaded module.
+                 * @param factory A pointer to the constructor function provided by the module.
                  * @param deleter A pointer to the destructor function provided by the module.
                  */
-                DynamicModule(std::string name, void * dllModule, DynamicModuleInterface * module, dynamicModuleDump * deleter);
-                friend std::unique_ptr<DynamicModule> makeDynamicModule(const std::string &, Comm::LocalBlackboardAdapter &, Comm::ExternalBlackboardAdapterMap &);
+                DynamicModule(std::string name, std::string filename, void * dllModule, DynamicModuleInterface * module,
+                              dynamicModuleFactory * factory, dynamicModuleDump * deleter);
+                friend std::unique_ptr<DynamicModule> makeDynamicModule(const DynamicLibrary &, Comm::LocalBlackboardAdapter &, Comm::ExternalBlackboardAdapterMap &);
         };
     } // Modules
 } //NaoFramework
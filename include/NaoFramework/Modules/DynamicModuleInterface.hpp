@@ -5,6 +5,7 @@
 #include <NaoFramework/Comm/ExternalBlackboardAdapterMap.hpp>
 
 #include <NaoFramework/Modules/ModuleInterface.hpp>
+#include <NaoFramework/Modules/StaticModuleRegistry.hpp>
 
 namespace NaoFramework {
     namespace Modules {
@@ -48,8 +49,14 @@ namespace NaoFramework {
  *
  * Note that the module's constructor will need to take different parameters than their parents!
  *
+ * If NAO_FRAMEWORK_STATIC_MODULES is defined, the module is instead meant to be linked into
+ * the framework, and is added to its StaticModuleRegistry.
+ *
  * @param X The name of the module class.
  */
+#ifdef NAO_FRAMEWORK_STATIC_MODULES
+#define MODULE_EXPORT(X) MODULE_REGISTER(X)
+#else
 #define MODULE_EXPORT(X)                                                                                                \
 extern "C" {                                                                                                            \
     NaoFramework::Modules::dynamicModuleFactory NAO_FRAMEWORK_DYNAMIC_MODULE_FACTORY;                                   \
@@ -64,5 +71,6 @@ extern "C" {
         *x = nullptr;                                                                                                   \
     }                                                                                                                   \
 }
+#endif
 
 #endif // Header guard
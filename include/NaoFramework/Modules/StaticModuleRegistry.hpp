@@ -0,0 +1,111 @@
+#ifndef NAO_FRAMEWORK_MODULES_STATIC_MODULE_REGISTRY_HEADER_FILE
+#define NAO_FRAMEWORK_MODULES_STATIC_MODULE_REGISTRY_HEADER_FILE
+
+#include <NaoFramework/Modules/ModuleInterface.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace NaoFramework {
+    namespace Comm {
+        class LocalBlackboardAdapter;
+        class ExternalBlackboardAdapterMap;
+    }
+    namespace Modules {
+        using staticModuleFactory = ModuleInterface* (Comm::LocalBlackboardAdapter &, Comm::ExternalBlackboardAdapterMap &);
+
+        /**
+         * @brief This class keeps track of the modules linked into the framework executable.
+         *
+         * Modules compiled with NAO_FRAMEWORK_STATIC_MODULES defined are not exported for
+         * dlopen(), but register themselves here through MODULE_REGISTER during static
+         * initialization. They can then be constructed by name, and are called directly
+         * without going through a DynamicModule wrapper, so that a build linking all modules
+         * together can optimize across them.
+         */
+        class StaticModuleRegistry {
+            public:
+                /**
+                 * @brief This function returns the registry of the executable.
+                 *
+                 * The registry is constructed on first use, so that modules can register
+                 * themselves regardless of the order of static initialization.
+                 *
+                 * @return The registry.
+                 */
+                static StaticModuleRegistry & get();
+
+                /**
+                 * @brief This function adds a module to the registry.
+                 *
+                 * @param name The name of the module class.
+                 * @param factory The function constructing the module.
+                 *
+                 * @return True if the module was added, false if a module with the same name was already there.
+                 */
+                bool add(const std::string & name, staticModuleFactory * factory);
+
+                /**
+                 * @brief This function checks whether a module is in the registry.
+                 *
+                 * @param name The name of the module class.
+                 *
+                 * @return True if the module is in the registry, false otherwise.
+                 */
+                bool contains(const std::string & name) const;
+
+                /**
+                 * @brief This function constructs a module in the registry.
+                 *
+                 * @param name The name of the module class.
+                 * @param mainComm The adapter for the module's BrainWave.
+                 * @param externalComm The adapter for all other BrainWaves.
+                 *
+                 * @return A pointer to the constructed module.
+                 * @throws If anything goes wrong, this function will throw an std::runtime_error.
+                 */
+                std::unique_ptr<ModuleInterface> make(const std::string & name, Comm::LocalBlackboardAdapter & mainComm,
+                                                                                Comm::ExternalBlackboardAdapterMap & externalComm) const;
+
+                /**
+                 * @brief This function returns the names of all modules in the registry.
+                 *
+                 * @return The names of the modules.
+                 */
+                std::vector<std::string> getNames() const;
+
+            private:
+                StaticModuleRegistry() = default;
+
+                std::unordered_map<std::string, staticModuleFactory*> factories_;
+        };
+
+        /**
+         * @brief This struct adds a module to the StaticModuleRegistry when constructed.
+         *
+         * It is meant to be used by MODULE_REGISTER only.
+         */
+        struct StaticModuleRegistration {
+            StaticModuleRegistration(const char * name, staticModuleFactory * factory) {
+                StaticModuleRegistry::get().add(name, factory);
+            }
+        };
+    } // Modules
+} //NaoFramework
+
+/**
+ * @brief This macro adds a module to the StaticModuleRegistry of the executable it is linked into.
+ *
+ * MODULE_EXPORT expands to this when NAO_FRAMEWORK_STATIC_MODULES is defined, so that
+ * the same module sources can be built either as shared libraries or into the framework.
+ *
+ * @param X The name of the module class.
+ */
+#define MODULE_REGISTER(X)                                                                                              \
+static NaoFramework::Modules::StaticModuleRegistration naoFrameworkStaticModule##X(#X,                                  \
+    []( NaoFramework::Comm::LocalBlackboardAdapter & comm, NaoFramework::Comm::ExternalBlackboardAdapterMap & others )  \
+    -> NaoFramework::Modules::ModuleInterface* { return new X(comm, others); } );
+
+#endif // Header guard
@@ -25,7 +25,7 @@ class Reader : public NaoFramework::Modules::DynamicModuleInterface {
 
         virtual void execute() { 
             int data = f_();
-            log("I'm Reader! From COM I read: "  + std::to_string(data));
+            NAO_LOGF(NaoFramework::Log::Info, "I'm Reader! From COM I read: %1%", data);
         }
     private:
         NaoFramework::Comm::RequireFunction<int> f_;
@@ -10,7 +10,11 @@ fi
 
 cd $1
 
-g++ -std=c++11 -I./../../include/ -fpic -c $1.cpp
+# NAO_LOG and NAO_LOGF drop messages below this priority at compile time. By default
+# modules keep them all, so that the loglevel command can turn them on at run time.
+LEVEL=${NAO_LOG_MINIMUM_PRIORITY:-Trace}
+
+g++ -std=c++11 -DNAO_LOG_MINIMUM_PRIORITY=NaoFramework::Log::$LEVEL -I./../../include/ -fpic -c $1.cpp
 g++ -std=c++11 -shared -o lib$1.so $1.o
 rm $1.o
 
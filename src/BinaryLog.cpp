@@ -0,0 +1,39 @@
+#include <NaoFramework/Log/BinaryLog.hpp>
+
+#include <boost/format.hpp>
+
+namespace NaoFramework {
+    namespace Log {
+        namespace BinaryLog {
+            std::string format(const std::string & format, const std::string & arguments) {
+                const char * data = arguments.data();
+                const char * end  = data + arguments.size();
+                try {
+                    boost::format message(format);
+                    uint8_t type;
+                    while ( get(data, end, type) ) {
+                        bool valid = true;
+                        switch ( type ) {
+                            case SignedArgument:   { int64_t  v; if ( (valid = get(data, end, v)) ) message % v; break; }
+                            case UnsignedArgument: { uint64_t v; if ( (valid = get(data, end, v)) ) message % v; break; }
+                            case FloatingArgument: { double   v; if ( (valid = get(data, end, v)) ) message % v; break; }
+                            case StringArgument:   { std::string v; if ( (valid = getString(data, end, v)) ) message % v; break; }
+                            default: valid = false;
+                        }
+                        if ( !valid ) return format + " [malformed arguments]";
+                    }
+                    return message.str();
+                }
+                catch ( boost::io::format_error & e ) {
+                    return format + " [" + e.what() + "]";
+                }
+            }
+
+            const char * getPriorityName(MessagePriority priority) {
+                static const char * names[] = { "trace", "debug", "info", "warning", "error", "fatal" };
+                if ( priority < Trace || priority > Fatal ) return "unknown";
+                return names[priority];
+            }
+        }
+    }
+}
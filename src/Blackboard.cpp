@@ -5,13 +5,71 @@ namespace NaoFramework {
         Blackboard::Blackboard(std::string name) : Loggable(name, "Blackboard"), name_(name) {}
         Blackboard::~Blackboard() {}
 
-        bool Blackboard::validateGlobals() const {
-            for ( auto pair : typeCheck_ ) {
+        bool Blackboard::validateGlobals() {
+            if ( !areGlobalsProvided() ) return false;
+            // Local provides cannot be globally required, and cannot coexist with global
+            // provides, so only the thread owning this Blackboard can touch them. Since
+            // all keys are provided, every slot which is not Buffered is local.
+            for ( auto & slot : slots_ ) {
+                if ( slot->getAccess() == SlotBase::Access::Locked )
+                    slot->unlock();
+            }
+            return true;
+        }
+
+        bool Blackboard::areGlobalsProvided() const {
+            for ( auto & pair : typeCheck_ ) {
                 if ( std::get<0>(pair.second) == TypeState::Requested ) return false;
             }
             return true;
         }
 
+        bool Blackboard::releaseGlobalProvide(const std::string & key) {
+            auto it = typeCheck_.find(key);
+            if ( it == std::end(typeCheck_) || std::get<0>(it->second) != TypeState::GlobalProvided ) return false;
+
+            log("Releasing global provide of " + key);
+            std::get<0>(it->second) = TypeState::Requested;
+            return true;
+        }
+
+        bool Blackboard::record(const std::string & key, Recorder & recorder, const std::atomic<unsigned long> * cycles) {
+            auto it = board_.find(key);
+            if ( it == std::end(board_) || !it->second->isSerializable() || it->second->isRecorded() ) return false;
+
+            log("Recording key " + key);
+            auto & slot = *(it->second);
+            slot.setRecorder(&recorder, recorder.addKey(name_, key, slot.getType().name(), cycles));
+            return true;
+        }
+
+        void Blackboard::stopRecording() {
+            for ( auto & slot : slots_ )
+                slot->setRecorder(nullptr, 0);
+        }
+
+        SlotBase * Blackboard::registerReplay(const std::string & key, const std::string & type) {
+            auto it = typeCheck_.find(key);
+            auto slot = board_.find(key);
+            if ( it == std::end(typeCheck_) || slot == std::end(board_) ) return nullptr;
+            // Replayed data takes the place of its provider, which must not be there.
+            if ( std::get<0>(it->second) != TypeState::Requested ) return nullptr;
+            if ( type != slot->second->getType().name() || !slot->second->isSerializable() ) return nullptr;
+
+            log("Replaying key " + key);
+            std::get<0>(it->second) = TypeState::GlobalProvided;
+            slot->second->makeBuffered();
+            return slot->second;
+        }
+
+        Trigger * Blackboard::getTrigger(const std::string & key) {
+            auto it = board_.find(key);
+            if ( it == std::end(board_) ) return nullptr;
+
+            log("Creating trigger for key " + key);
+            return &(it->second->getTrigger());
+        }
+
         const std::string & Blackboard::getName() const {
             return name_;
         }
@@ -4,8 +4,23 @@
 #include <NaoFramework/Comm/ExternalBlackboardAdapter.hpp>
 #include <NaoFramework/Comm/ExternalBlackboardAdapterMap.hpp>
 #include <NaoFramework/Comm/LocalBlackboardAdapter.hpp>
+#include <NaoFramework/Modules/StaticModuleRegistry.hpp>
+#include <NaoFramework/Comm/Trigger.hpp>
+#include <NaoFramework/Core/VirtualClock.hpp>
 
 #include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sched.h>
+
+#include <boost/filesystem/path.hpp>
 
 using std::cout;
 
@@ -13,20 +28,34 @@ namespace NaoFramework {
     namespace Core {
         class Brain::ExternalBlackboardMap : public Comm::ExternalBlackboardAdapterMap {
             public:
-                ExternalBlackboardMap(Brain & b) : brain_(b) {}
+                // Global requires on the module's own wave are recorded in the dependencies,
+                // as they also need to be ordered within the wave.
+                ExternalBlackboardMap(Brain & b, const std::string & wave, Comm::Dependencies & d) :
+                                                                    brain_(b), wave_(wave), dependencies_(d) {}
                 virtual Comm::ExternalBlackboardAdapter operator[]( const std::string & key ) {
                     if ( !brain_.waveExists(key) ) {
                         brain_.makeWave(key);
                         std::cout << "A new wave was referenced, and thus created: " << key << '\n';
                     }
-                    return Comm::ExternalBlackboardAdapter(*(brain_.waves_.at(key).second));
+                    return Comm::ExternalBlackboardAdapter(*(brain_.waves_.at(key).second),
+                                                           key == wave_ ? &dependencies_ : nullptr);
                 }
             private:
                 Brain & brain_;
+                std::string wave_;
+                Comm::Dependencies & dependencies_;
         };
 
+        // Global requires on the module's own wave are recorded apart from the local
+        // registrations, so we put them together.
+        static void mergeDependencies(Comm::Dependencies & dependencies, const Comm::Dependencies & local) {
+            dependencies.required.insert(std::end(dependencies.required), std::begin(local.required), std::end(local.required));
+            dependencies.provided = local.provided;
+        }
+
         Brain::Brain() {}
         Brain::~Brain() {
+            watchdog_.reset();
             for ( auto & wave : waves_ )
                 wave.second.first.pause();
             blackboards_.clear();
@@ -74,27 +103,162 @@ namespace NaoFramework {
                 return 1;
             }
 
-            auto wave = inputs[1];
-            auto module = inputs[2];
+            // Modules linked into the framework take precedence, so the same scripts
+            // work whether modules are built as libraries or not.
+            auto staticName = getStaticName(inputs[2]);
+            if ( !staticName.empty() ) return addStaticModule(inputs[1], staticName) ? 0 : 1;
 
             unsigned loaded = 1; // 1 = Error!
             try {
+                auto library = Modules::openDynamicModule(inputs[2]);
+                if ( addLibrary(inputs[1], library) ) loaded = 0;
+            }
+            catch ( std::runtime_error & e ) {
+                std::cout << "Could not load module: " << e.what() << "\n";
+            }
+            return loaded;
+        }
+
+        unsigned Brain::loadDynamicModules(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name module_filename [module_filename ...]\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            using Clock = std::chrono::steady_clock;
+            auto start = Clock::now();
+
+            // Opening libraries does not touch the Blackboards, so it's done concurrently.
+            // The loader serializes dlopen(), so threads mostly overlap disk reads, which
+            // is why we don't limit them to the number of cores.
+            static const size_t maxOpeners = 8;
+            size_t count = inputs.size() - 2;
+            std::vector<Modules::DynamicLibrary> libraries(count);
+            std::vector<std::string> errors(count);
+            std::vector<std::string> staticNames(count);
+            for ( size_t i = 0; i < count; ++i ) staticNames[i] = getStaticName(inputs[i + 2]);
+            {
+                WorkerPool pool(std::min(count - 1, maxOpeners - 1));
+                pool.run(count, [&](size_t i) {
+                    if ( !staticNames[i].empty() ) return;
+                    try {
+                        libraries[i] = Modules::openDynamicModule(inputs[i + 2]);
+                    }
+                    catch ( std::runtime_error & e ) {
+                        errors[i] = e.what();
+                    }
+                });
+            }
+            auto opened = Clock::now();
+
+            // Registrations must happen one at a time, and in order.
+            auto first = loadTimes_.size();
+            unsigned failed = 0;
+            for ( size_t i = 0; i < count; ++i ) {
+                if ( !errors[i].empty() ) {
+                    std::cout << "Could not load module " << inputs[i + 2] << ": " << errors[i] << "\n";
+                    ++failed;
+                }
+                else if ( !staticNames[i].empty() ) {
+                    if ( !addStaticModule(inputs[1], staticNames[i]) ) ++failed;
+                }
+                else if ( !addLibrary(inputs[1], libraries[i]) ) ++failed;
+            }
+            auto constructed = Clock::now();
+
+            printLoadTimes(first);
+            auto ms = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / 1000.0; };
+            std::cout << std::fixed << std::setprecision(1)
+                      << "Loaded " << count - failed << " of " << count << " modules in " << ms(constructed - start) << " ms: "
+                      << ms(opened - start) << " ms opening concurrently, "
+                      << ms(constructed - opened) << " ms constructing.\n" << std::defaultfloat;
+
+            return failed ? 1 : 0;
+        }
+
+        unsigned Brain::printStartup(Inputs) {
+            printLoadTimes(0);
+            return 0;
+        }
+
+        bool Brain::addModule(const std::string & wave, const ModuleMaker & make, LoadTimes times) {
+            try {
+                Comm::Dependencies dependencies;
                 auto adapter   = Comm::LocalBlackboardAdapter(*(waves_.at(wave).second));
-                auto globals   = ExternalBlackboardMap(*this);
+                auto globals   = ExternalBlackboardMap(*this, wave, dependencies);
 
-                auto dynModule = Modules::makeDynamicModule(module, adapter, globals);
+                auto start = std::chrono::steady_clock::now();
+                auto module = make(adapter, globals);
+                times.construct = std::chrono::steady_clock::now() - start;
 
-                auto moduleName = dynModule->getName();
+                auto moduleName = module->getName();
 
-                waves_.at(wave).first.addModule(std::move(dynModule)); // Give ownership -> dynModule empty
+                mergeDependencies(dependencies, adapter.getDependencies());
 
+                waves_.at(wave).first.addModule(std::move(module), dependencies); // Give ownership -> module empty
+
+                times.module = moduleName;
+                times.wave = wave;
+                loadTimes_.push_back(times);
                 std::cout << "Successfully loaded module: " << moduleName << "\n";
-                loaded = 0;
+                return true;
             }
             catch ( std::runtime_error & e ) {
                 std::cout << "Could not load module: " << e.what() << "\n";
             }
-            return loaded;
+            return false;
+        }
+
+        bool Brain::addLibrary(const std::string & wave, const Modules::DynamicLibrary & library) {
+            return addModule(wave, [&library](Comm::LocalBlackboardAdapter & adapter, Comm::ExternalBlackboardAdapterMap & globals) {
+                                       return BrainWave::Module(Modules::makeDynamicModule(library, adapter, globals));
+                                   },
+                             {"", "", library.readTime, library.openTime, library.resolveTime, {}});
+        }
+
+        bool Brain::addStaticModule(const std::string & wave, const std::string & name) {
+            return addModule(wave, [&name](Comm::LocalBlackboardAdapter & adapter, Comm::ExternalBlackboardAdapterMap & globals) {
+                                       return Modules::StaticModuleRegistry::get().make(name, adapter, globals);
+                                   },
+                             {"", "", {}, {}, {}, {}});
+        }
+
+        std::string Brain::getStaticName(const std::string & moduleFilename) {
+            // Scripts name modules by their libraries, as in path/to/libWriter.so
+            auto name = boost::filesystem::path(moduleFilename).stem().string();
+            if ( name.compare(0, 3, "lib") == 0 && !Modules::StaticModuleRegistry::get().contains(name) )
+                name = name.substr(3);
+
+            return Modules::StaticModuleRegistry::get().contains(name) ? name : "";
+        }
+
+        void Brain::printLoadTimes(size_t first) const {
+            auto us = [](std::chrono::nanoseconds d) { return d.count() / 1000.0; };
+            auto printLine = [&us](const std::string & module, const std::string & wave, const LoadTimes & t) {
+                std::cout << std::left << std::setw(24) << module << std::setw(16) << wave << std::right
+                          << std::setw(12) << us(t.read)      << std::setw(12) << us(t.open)
+                          << std::setw(12) << us(t.resolve)   << std::setw(12) << us(t.construct) << '\n';
+            };
+
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << "Module loading times in microseconds:\n";
+            std::cout << std::left << std::setw(24) << "module" << std::setw(16) << "wave" << std::right
+                      << std::setw(12) << "read"     << std::setw(12) << "dlopen"
+                      << std::setw(12) << "dlsym"    << std::setw(12) << "construct" << '\n';
+
+            LoadTimes total{"", "", {}, {}, {}, {}};
+            for ( size_t i = first; i < loadTimes_.size(); ++i ) {
+                auto & t = loadTimes_[i];
+                printLine(t.module, t.wave, t);
+                total.read += t.read; total.open += t.open;
+                total.resolve += t.resolve; total.construct += t.construct;
+            }
+            printLine("[total]", "", total);
+            std::cout << std::defaultfloat;
         }
 
         unsigned Brain::execute(Inputs) {
@@ -113,5 +277,591 @@ namespace NaoFramework {
 
             return 0;
         }
+
+        unsigned Brain::setWavePeriod(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name milliseconds (0 runs cycles back-to-back)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            double milliseconds;
+            try {
+                milliseconds = std::stod(inputs[2]);
+            }
+            catch ( std::logic_error & ) {
+                std::cout << "Error, '" << inputs[2] << "' is not a number.\n";
+                return 1;
+            }
+            if ( milliseconds < 0.0 ) {
+                std::cout << "Error, the period cannot be negative.\n";
+                return 1;
+            }
+
+            auto & wave = waves_.at(inputs[1]).first;
+            wave.setPeriod(std::chrono::microseconds(static_cast<long long>(milliseconds * 1000.0)));
+
+            std::cout << "Wave '" << inputs[1] << "' period set to " << milliseconds << " ms.\n";
+            return 0;
+        }
+
+        unsigned Brain::setWaveTrigger(Inputs inputs) {
+            if ( inputs.size() < 2 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name [key [source_wave]] (no key removes the trigger)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+            auto & wave = waves_.at(inputs[1]).first;
+
+            if ( inputs.size() == 2 ) {
+                wave.setTrigger(nullptr);
+                std::cout << "Wave '" << inputs[1] << "' now runs without trigger.\n";
+                return 0;
+            }
+
+            auto & source = inputs.size() > 3 ? inputs[3] : inputs[1];
+            if ( !waveExists(source) ) {
+                std::cout << "Error, wave '" << source << "' does not exist.\n";
+                return 1;
+            }
+
+            auto trigger = waves_.at(source).second->getTrigger(inputs[2]);
+            if ( !trigger ) {
+                std::cout << "Error, key '" << inputs[2] << "' is not registered in wave '" << source << "'.\n";
+                return 1;
+            }
+            wave.setTrigger(trigger);
+
+            std::cout << "Wave '" << inputs[1] << "' now runs on updates of '" << inputs[2] << "' from wave '" << source << "'.\n";
+            return 0;
+        }
+
+        unsigned Brain::printStatistics(Inputs inputs) {
+            if ( inputs.size() < 2 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name [reset]\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+            auto & wave = waves_.at(inputs[1]).first;
+
+            if ( inputs.size() > 2 && inputs[2] == "reset" ) {
+                wave.resetStatistics();
+                std::cout << "Statistics of wave '" << inputs[1] << "' reset.\n";
+                return 0;
+            }
+
+            auto printLine = [](const std::string & name, const TimingStatistics::Summary & s) {
+                auto us = [](TimingStatistics::Duration d) { return d.count() / 1000.0; };
+                std::cout << std::left << std::setw(24) << name << std::right
+                          << std::setw(10) << s.count
+                          << std::setw(10) << us(s.min)  << std::setw(10) << us(s.mean)
+                          << std::setw(10) << us(s.p50)  << std::setw(10) << us(s.p90)
+                          << std::setw(10) << us(s.p99)  << std::setw(10) << us(s.max) << '\n';
+            };
+
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << "Timings of wave '" << inputs[1] << "' in microseconds:\n";
+            std::cout << std::left << std::setw(24) << "module" << std::right
+                      << std::setw(10) << "count"
+                      << std::setw(10) << "min"  << std::setw(10) << "mean"
+                      << std::setw(10) << "p50"  << std::setw(10) << "p90"
+                      << std::setw(10) << "p99"  << std::setw(10) << "max" << '\n';
+            for ( auto & pair : wave.getModuleStatistics() )
+                printLine(pair.first, pair.second);
+            printLine("[cycle]", wave.getCycleStatistics());
+            std::cout << "Overruns: " << wave.getOverruns() << '\n';
+            if ( wave.getDeadline().count() ) {
+                std::cout << "Deadline misses: " << wave.getDeadlineMisses();
+                auto offender = wave.getLastMissOffender();
+                if ( !offender.empty() ) std::cout << ", last caused by " << offender;
+                std::cout << '\n';
+            }
+            std::cout << std::defaultfloat;
+
+            return 0;
+        }
+
+        unsigned Brain::setWaveParallel(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name workers (0 runs modules sequentially)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            unsigned long workers;
+            try {
+                workers = std::stoul(inputs[2]);
+            }
+            catch ( std::logic_error & ) {
+                std::cout << "Error, '" << inputs[2] << "' is not a number.\n";
+                return 1;
+            }
+
+            auto & wave = waves_.at(inputs[1]).first;
+            wave.setParallel(workers);
+
+            if ( workers == 0 ) {
+                std::cout << "Wave '" << inputs[1] << "' now runs modules sequentially.\n";
+                return 0;
+            }
+            std::cout << "Wave '" << inputs[1] << "' now runs modules on " << workers << " additional threads, in stages:\n";
+            unsigned counter = 0;
+            for ( auto & stage : wave.getStages() ) {
+                std::cout << "\t[" << counter++ << "]";
+                for ( auto & name : stage ) std::cout << ' ' << name;
+                std::cout << '\n';
+            }
+            return 0;
+        }
+
+        unsigned Brain::setWaveExecutor(Inputs inputs) {
+            if ( inputs.size() < 3 || (inputs[2] != "shared" && inputs[2] != "dedicated") ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name shared [high|normal|low]\n"
+                          << "       " << inputs[0] << " wave_name dedicated (use parallel to add threads again)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+            auto & wave = waves_.at(inputs[1]).first;
+
+            if ( inputs[2] == "dedicated" ) {
+                wave.setExecutor(nullptr);
+                std::cout << "Wave '" << inputs[1] << "' now runs modules sequentially on its own thread.\n";
+                return 0;
+            }
+
+            auto & scheduling = wave.getScheduling();
+            if ( scheduling.policy != BrainWave::Scheduling::Default || !scheduling.cpus.empty() ) {
+                std::cout << "Error, wave '" << inputs[1] << "' has its own scheduling, which the shared executor cannot follow.\n";
+                return 1;
+            }
+
+            auto priority = Executor::Normal;
+            if ( inputs.size() > 3 ) {
+                if      ( inputs[3] == "high" )   priority = Executor::High;
+                else if ( inputs[3] == "normal" ) priority = Executor::Normal;
+                else if ( inputs[3] == "low" )    priority = Executor::Low;
+                else {
+                    std::cout << "Error, unknown priority '" << inputs[3] << "'.\n";
+                    return 1;
+                }
+            }
+
+            if ( !executor_ ) {
+                // Each wave thread runs tasks as well, so one fewer worker keeps cores busy without oversubscribing.
+                unsigned cores = std::thread::hardware_concurrency();
+                executor_.reset(new Executor(cores > 1 ? cores - 1 : 1));
+                std::cout << "Started shared executor with " << executor_->getWorkers() << " threads.\n";
+            }
+            wave.setExecutor(executor_.get(), priority);
+
+            std::cout << "Wave '" << inputs[1] << "' now runs modules on the shared executor, in stages:\n";
+            unsigned counter = 0;
+            for ( auto & stage : wave.getStages() ) {
+                std::cout << "\t[" << counter++ << "]";
+                for ( auto & name : stage ) std::cout << ' ' << name;
+                std::cout << '\n';
+            }
+            return 0;
+        }
+    
+        unsigned Brain::setWaveScheduling(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name default|fifo|rr [priority [cpu,cpu,...]]\n"
+                          << "       Parallel workers of the wave follow it too, but not the shared executor.\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            BrainWave::Scheduling scheduling;
+            if      ( inputs[2] == "default" ) scheduling.policy = BrainWave::Scheduling::Default;
+            else if ( inputs[2] == "fifo" )    scheduling.policy = BrainWave::Scheduling::Fifo;
+            else if ( inputs[2] == "rr" )      scheduling.policy = BrainWave::Scheduling::RoundRobin;
+            else {
+                std::cout << "Error, unknown policy '" << inputs[2] << "'.\n";
+                return 1;
+            }
+
+            scheduling.priority = 0;
+            try {
+                if ( inputs.size() > 3 ) scheduling.priority = std::stoi(inputs[3]);
+
+                if ( inputs.size() > 4 ) {
+                    std::istringstream cpus(inputs[4]);
+                    std::string cpu;
+                    while ( std::getline(cpus, cpu, ',') )
+                        scheduling.cpus.push_back(std::stoul(cpu));
+                }
+            }
+            catch ( std::logic_error & ) {
+                std::cout << "Error, priority and CPUs must be numbers.\n";
+                return 1;
+            }
+            if ( scheduling.policy != BrainWave::Scheduling::Default &&
+                 ( scheduling.priority < 1 || scheduling.priority > 99 ) ) {
+                std::cout << "Error, real-time priorities go from 1 to 99.\n";
+                return 1;
+            }
+            for ( auto cpu : scheduling.cpus ) {
+                if ( cpu >= CPU_SETSIZE ) {
+                    std::cout << "Error, CPU " << cpu << " does not exist.\n";
+                    return 1;
+                }
+            }
+
+            auto & wave = waves_.at(inputs[1]).first;
+            // Executor threads are shared, so its tasks would lose the priority of the wave.
+            if ( wave.getExecutor() && ( scheduling.policy != BrainWave::Scheduling::Default || !scheduling.cpus.empty() ) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' runs on the shared executor, which cannot follow its scheduling.\n";
+                return 1;
+            }
+            wave.setScheduling(scheduling);
+
+            std::cout << "Wave '" << inputs[1] << "' scheduling set, it is applied when its thread starts.\n";
+            return 0;
+        }
+
+        unsigned Brain::lockMemory(Inputs) {
+            // Page faults are a source of jitter as bad as preemption, so we lock
+            // both what we have already mapped and everything we will map.
+            if ( mlockall(MCL_CURRENT | MCL_FUTURE) ) {
+                std::cout << "Error, could not lock memory: " << std::strerror(errno) << "\n";
+                return 1;
+            }
+            std::cout << "All memory of the process is now locked in RAM.\n";
+            return 0;
+        }
+    
+        unsigned Brain::setWaveDeadline(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name milliseconds [skippable_module ...] (0 removes the deadline)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            double milliseconds;
+            try {
+                milliseconds = std::stod(inputs[2]);
+            }
+            catch ( std::logic_error & ) {
+                std::cout << "Error, '" << inputs[2] << "' is not a number.\n";
+                return 1;
+            }
+            if ( milliseconds < 0.0 ) {
+                std::cout << "Error, the deadline cannot be negative.\n";
+                return 1;
+            }
+
+            auto & wave = waves_.at(inputs[1]).first;
+            for ( size_t i = 3; i < inputs.size(); ++i ) {
+                if ( !wave.setSkippable(inputs[i], true) ) {
+                    std::cout << "Error, module '" << inputs[i] << "' is not in wave '" << inputs[1] << "'.\n";
+                    return 1;
+                }
+            }
+            wave.setDeadline(std::chrono::microseconds(static_cast<long long>(milliseconds * 1000.0)));
+
+            if ( !watchdog_ ) watchdog_.reset(new Watchdog());
+            watchdog_->watch(wave);
+
+            std::cout << "Wave '" << inputs[1] << "' deadline set to " << milliseconds << " ms";
+            if ( inputs.size() > 3 ) std::cout << ", " << inputs.size() - 3 << " modules can be skipped to catch up";
+            std::cout << ".\n";
+            return 0;
+        }
+    
+        unsigned Brain::reloadDynamicModule(Inputs inputs) {
+            if ( inputs.size() < 3 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name module_name [module_filename]\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+
+            auto & wave = waves_.at(inputs[1]).first;
+            auto & blackboard = *(waves_.at(inputs[1]).second);
+            std::string filename = inputs.size() > 3 ? inputs[3] : "";
+            bool valid = true;
+
+            auto reload = [&](Modules::ModuleInterface & module, const Comm::Dependencies * old) {
+                auto dynamicModule = dynamic_cast<Modules::DynamicModule*>(&module);
+                if ( !dynamicModule ) throw std::runtime_error("the module was not loaded from a shared library");
+
+                // The new module has to be able to provide the same global keys again.
+                if ( old )
+                    for ( auto & key : old->provided )
+                        blackboard.releaseGlobalProvide(key);
+
+                Comm::Dependencies dependencies;
+                auto adapter = Comm::LocalBlackboardAdapter(blackboard);
+                auto globals = ExternalBlackboardMap(*this, inputs[1], dependencies);
+
+                // A failed new module may have taken the global keys of the old one, which
+                // must be able to provide them again when it is restored.
+                auto rollback = [&]() {
+                    for ( auto & key : adapter.getDependencies().provided )
+                        blackboard.releaseGlobalProvide(key);
+                };
+                dynamicModule->reload(filename.empty() ? dynamicModule->getFilename() : filename, adapter, globals, rollback);
+
+                mergeDependencies(dependencies, adapter.getDependencies());
+                // New keys need the same checks as at startup. Only the Blackboard of this wave
+                // may stop locking new local keys, as the other waves are still running.
+                valid = blackboard.validateGlobals();
+                for ( auto & b : blackboards_ )
+                    if ( &b != &blackboard ) valid = b.areGlobalsProvided() && valid;
+                return dependencies;
+            };
+
+            try {
+                auto & name = inputs[2];
+                if ( !wave.updateModule(name, reload) && !wave.updateModule("Dynamic" + name, reload) ) {
+                    std::cout << "Error, module '" << name << "' is not in wave '" << inputs[1] << "'.\n";
+                    return 1;
+                }
+            }
+            catch ( std::runtime_error & e ) {
+                std::cout << "Could not reload module: " << e.what() << "\n";
+                return 1;
+            }
+
+            std::cout << "Successfully reloaded module: " << inputs[2] << "\n";
+            if ( !valid ) {
+                std::cout << "Warning, the new module changed what is provided, and dependencies are not met anymore!\n";
+                return 1;
+            }
+            return 0;
+        }
+
+        unsigned Brain::recordKeys(Inputs inputs) {
+            if ( inputs.size() == 2 && inputs[1] == "stop" ) {
+                for ( auto & b : blackboards_ ) b.stopRecording();
+                for ( auto & recorder : recorders_ ) recorder->finish();
+                std::cout << "Recording stopped.\n";
+                return 0;
+            }
+            if ( inputs.size() < 4 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name filename key [key...], or " << inputs[0] << " stop\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+            auto & wave = waves_.at(inputs[1]).first;
+            auto & blackboard = *(waves_.at(inputs[1]).second);
+
+            std::unique_ptr<Comm::Recorder> recorder(new Comm::Recorder(inputs[2]));
+            if ( !recorder->isOpen() ) {
+                std::cout << "Error, could not create recording '" << inputs[2] << "'.\n";
+                return 1;
+            }
+
+            unsigned recorded = 0;
+            for ( size_t i = 3; i < inputs.size(); ++i ) {
+                if ( blackboard.record(inputs[i], *recorder, &wave.getCycles()) ) ++recorded;
+                else std::cout << "Warning, key '" << inputs[i] << "' is not registered in wave '" << inputs[1]
+                               << "', its type has no Serializer, or it is already recorded until 'record stop'.\n";
+            }
+            // Nothing points to the recorder yet, so it can go.
+            if ( !recorded ) {
+                std::cout << "Error, no key to record.\n";
+                return 1;
+            }
+            recorders_.push_back(std::move(recorder));
+
+            std::cout << "Recording " << recorded << " keys of wave '" << inputs[1] << "' into '" << inputs[2] << "'.\n";
+            return 0;
+        }
+
+        unsigned Brain::replayRecording(Inputs inputs) {
+            if ( inputs.size() < 2 ) {
+                std::cout << "Usage: " << inputs[0] << " wave_name [filename] (no filename stops replaying)\n";
+                return 1;
+            }
+            if ( !waveExists(inputs[1]) ) {
+                std::cout << "Error, wave '" << inputs[1] << "' does not exist.\n";
+                return 1;
+            }
+            auto & wave = waves_.at(inputs[1]).first;
+            auto & blackboard = *(waves_.at(inputs[1]).second);
+
+            // Replayed keys become provided, which can't change under running modules.
+            if ( wave.isRunning() ) {
+                std::cout << "Error, wave '" << inputs[1] << "' is running.\n";
+                return 1;
+            }
+            if ( inputs.size() == 2 || wave.getReplayer() ) {
+                auto replayer = wave.getReplayer();
+                wave.setReplayer(nullptr);
+                if ( replayer ) replayer->detach(blackboard);
+                if ( inputs.size() == 2 ) {
+                    std::cout << "Wave '" << inputs[1] << "' does not replay anymore.\n";
+                    return 0;
+                }
+            }
+
+            std::unique_ptr<Comm::Replayer> replayer(new Comm::Replayer(inputs[2]));
+            if ( !replayer->isOpen() ) {
+                std::cout << "Error, could not read recording '" << inputs[2] << "'.\n";
+                return 1;
+            }
+
+            std::vector<std::string> skipped;
+            auto replayed = replayer->attach(blackboard, skipped);
+            for ( auto & key : skipped )
+                std::cout << "Warning, key '" << key << "' is provided by a module, or not required with the recorded type.\n";
+            if ( !replayed ) {
+                std::cout << "Error, no key to replay in wave '" << inputs[1] << "'.\n";
+                return 1;
+            }
+            wave.setReplayer(replayer.get());
+            replayers_.push_back(std::move(replayer));
+
+            std::cout << "Wave '" << inputs[1] << "' now replays " << replayed << " keys from '" << inputs[2] << "'.\n";
+            return 0;
+        }
+
+        unsigned Brain::simulate(Inputs inputs) {
+            if ( inputs.size() < 2 ) {
+                std::cout << "Usage: " << inputs[0] << " milliseconds [default_period_milliseconds] (default period 10)\n";
+                return 1;
+            }
+            double milliseconds, defaultPeriod = 10.0;
+            try {
+                milliseconds = std::stod(inputs[1]);
+                if ( inputs.size() > 2 ) defaultPeriod = std::stod(inputs[2]);
+            }
+            catch ( std::logic_error & ) {
+                std::cout << "Error, '" << inputs[1] << (inputs.size() > 2 ? "' or '" + inputs[2] : "") << "' is not a number.\n";
+                return 1;
+            }
+            if ( milliseconds < 0.0 || defaultPeriod <= 0.0 ) {
+                std::cout << "Error, the duration cannot be negative, and the default period must be positive.\n";
+                return 1;
+            }
+            for ( auto & b : blackboards_ ) {
+                if ( ! b.validateGlobals() ) {
+                    std::cout << "Dependencies for wave '" << b.getName() << "' are not met!\n";
+                    return 1;
+                }
+            }
+
+            using Duration = VirtualClock::duration;
+            auto toDuration = [](double ms) { return Duration(static_cast<Duration::rep>(ms * 1000000.0)); };
+
+            // Waves are run in order of their next cycle, ties and triggered waves in order
+            // of name, so that every run of the same modules on the same data is the same.
+            struct Simulated {
+                std::string name;
+                BrainWave * wave;
+                Comm::Trigger * trigger;
+                unsigned long seen;
+                Duration period;
+                VirtualClock::time_point next;
+                unsigned long cycles;
+                bool wasRunning;
+            };
+            std::vector<Simulated> simulated;
+            for ( auto & pair : waves_ ) {
+                auto & wave = pair.second.first;
+                auto period = std::chrono::duration_cast<Duration>(wave.getPeriod());
+                // Replayed waves are driven by their recording, as on their own thread.
+                auto trigger = wave.getReplayer() ? nullptr : wave.getTrigger();
+                simulated.push_back({ pair.first, &wave, trigger, trigger ? trigger->getCount() : 0,
+                                      period.count() ? period : toDuration(defaultPeriod),
+                                      VirtualClock::time_point(), 0, wave.isRunning() });
+            }
+            std::sort(std::begin(simulated), std::end(simulated),
+                      [](const Simulated & lhs, const Simulated & rhs){ return lhs.name < rhs.name; });
+
+            // A replayed simulation ends with its recording.
+            auto replayFinished = [&simulated]() {
+                bool replaying = false;
+                for ( auto & s : simulated ) {
+                    auto replayer = s.wave->getReplayer();
+                    if ( !replayer ) continue;
+                    if ( !replayer->isFinished() ) return false;
+                    replaying = true;
+                }
+                return replaying;
+            };
+
+            for ( auto & s : simulated ) s.wave->pause();
+
+            auto runCycle = [](Simulated & s) {
+                s.wave->simulateCycle();
+                ++s.cycles;
+            };
+
+            VirtualClock::time_point end(toDuration(milliseconds));
+            VirtualClock::startSimulation();
+            auto wallStart = std::chrono::steady_clock::now();
+            while ( !replayFinished() ) {
+                Simulated * next = nullptr;
+                for ( auto & s : simulated )
+                    if ( !s.trigger && (!next || s.next < next->next) ) next = &s;
+                if ( !next || next->next > end ) break;
+
+                VirtualClock::advance(next->next);
+                runCycle(*next);
+                next->next += next->period;
+
+                // Triggered waves run at the time of the cycle which notified them. Each round can
+                // only trigger waves again through a chain, which can't be longer than the waves.
+                bool triggered = true;
+                for ( size_t round = 0; triggered && round < simulated.size(); ++round ) {
+                    triggered = false;
+                    for ( auto & s : simulated ) {
+                        if ( !s.trigger ) continue;
+                        auto count = s.trigger->getCount();
+                        if ( count == s.seen ) continue;
+                        s.seen = count;
+                        runCycle(s);
+                        triggered = true;
+                    }
+                }
+            }
+            std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wallStart;
+            std::chrono::duration<double, std::milli> simulatedTime = VirtualClock::now().time_since_epoch();
+            VirtualClock::stopSimulation();
+
+            for ( auto & s : simulated )
+                if ( s.wasRunning ) s.wave->execute();
+
+            unsigned long cycles = 0;
+            for ( auto & s : simulated ) {
+                std::cout << "Wave '" << s.name << "': " << s.cycles << " cycles.\n";
+                cycles += s.cycles;
+            }
+            std::cout << std::fixed << std::setprecision(1)
+                      << "Simulated " << simulatedTime.count() << " ms in " << wall.count() << " ms, "
+                      << (wall.count() > 0.0 ? simulatedTime.count() / wall.count() : 0.0) << " times real time, "
+                      << (wall.count() > 0.0 ? cycles * 1000.0 / wall.count() : 0.0) << " cycles per second.\n"
+                      << std::defaultfloat;
+            return 0;
+        }
     }
 }
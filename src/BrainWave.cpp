@@ -1,27 +1,86 @@
 #include <NaoFramework/Core/BrainWave.hpp>
 
 #include <NaoFramework/Modules/ModuleInterface.hpp>
+#include <NaoFramework/Comm/Trigger.hpp>
+#include <NaoFramework/Comm/Replayer.hpp>
 #include <NaoFramework/Log/Frontend.hpp>
 
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
 namespace NaoFramework {
     namespace Core {
+        using Clock = std::chrono::steady_clock;
+
+        // How long we wait for a Trigger before checking whether we have been paused.
+        static const std::chrono::milliseconds triggerTimeout(100);
+
+        // std::chrono::steady_clock is CLOCK_MONOTONIC, so we can sleep on
+        // absolute deadlines and avoid drifting away from the wanted rate.
+        static void sleepUntil(Clock::time_point deadline) {
+            auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            timespec t;
+            t.tv_sec  = sinceEpoch / 1000000000;
+            t.tv_nsec = sinceEpoch % 1000000000;
+            while ( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr) == EINTR ) {}
+        }
+
         BrainWave::BrainWave(std::string name) : Loggable(name, "BrainWave"), 
-                                                 name_(name), running_(false) {}
+                                                 name_(name), executor_(nullptr),
+                                                 priority_(Executor::Normal),
+                                                 scheduling_{Scheduling::Default, 0, {}},
+                                                 deadline_(0), misses_(0), lastMiss_(-1), catchingUp_(false),
+                                                 cycles_(0), cycleStart_(0), inCycle_(false), currentModule_(-1),
+                                                 running_(false), parked_(true), quitting_(false), rescheduled_(false),
+                                                 period_(0), overruns_(0), trigger_(nullptr), replayer_(nullptr),
+                                                 cycleStatistics_(new TimingStatistics()),
+                                                 resetStatistics_(false) {}
         BrainWave::~BrainWave() {
-            pause(); // We stop the thread when we die
+            stop(); // We stop the thread when we die
         }
 
         BrainWave::BrainWave(BrainWave && other) : Loggable(std::move(other)),
                                                    name_(std::move(other.name_)), 
-                                                   running_(other.running_.load(std::memory_order_acquire))
+                                                   executor_(other.executor_),
+                                                   priority_(other.priority_),
+                                                   scheduling_(std::move(other.scheduling_)),
+                                                   deadline_(other.deadline_.load()),
+                                                   misses_(other.misses_.load()),
+                                                   lastMiss_(other.lastMiss_.load()),
+                                                   catchingUp_(false),
+                                                   cycles_(other.cycles_.load()),
+                                                   cycleStart_(0), inCycle_(false), currentModule_(-1),
+                                                   running_(false), parked_(true), quitting_(false), rescheduled_(false),
+                                                   period_(other.period_.load()),
+                                                   overruns_(other.overruns_.load()),
+                                                   trigger_(other.trigger_.load()),
+                                                   replayer_(other.replayer_.load()),
+                                                   resetStatistics_(false)
         {
-            // If the other guy is running, we stop, copy data, and restart
-            bool running = running_.load(std::memory_order_acquire);
-
-            if ( running ) other.pause();
+            // If the other guy is running, we stop its thread, copy data, and
+            // start our own, as its thread references the other object.
+            bool running = other.isRunning();
+            other.stop();
 
             modules_ = std::move(other.modules_);
             indices_ = std::move(other.indices_);
+            {
+                std::lock_guard<std::mutex> lock(other.namesMutex_);
+                names_ = std::move(other.names_);
+            }
+
+            moduleStatistics_ = std::move(other.moduleStatistics_);
+            cycleStatistics_  = std::move(other.cycleStatistics_);
+
+            dependencies_     = std::move(other.dependencies_);
+            stages_           = std::move(other.stages_);
+            pool_             = std::move(other.pool_);
+
+            skippable_        = std::move(other.skippable_);
+            lastDurations_    = std::move(other.lastDurations_);
 
             if ( running ) execute();
         }
@@ -29,16 +88,41 @@ namespace NaoFramework {
         const BrainWave & BrainWave::operator=(BrainWave && other) {
             Loggable::operator=(std::move(other));
 
-            pause(); // Stop whatever we where doing.
+            stop(); // Stop whatever we where doing.
 
             name_ = std::move(other.name_); // It's important to remove the name so that we don't close its sink.
 
-            bool running = running_ = other.running_.load(std::memory_order_acquire);
+            bool running = other.isRunning();
+            other.stop();
 
-            if ( running ) other.pause();
+            period_     = other.period_.load();
+            overruns_   = other.overruns_.load();
+            trigger_    = other.trigger_.load();
+            replayer_   = other.replayer_.load();
 
             modules_ = std::move(other.modules_);
             indices_ = std::move(other.indices_);
+            {
+                std::lock_guard<std::mutex> lock(other.namesMutex_);
+                names_ = std::move(other.names_);
+            }
+
+            moduleStatistics_ = std::move(other.moduleStatistics_);
+            cycleStatistics_  = std::move(other.cycleStatistics_);
+
+            dependencies_     = std::move(other.dependencies_);
+            stages_           = std::move(other.stages_);
+            pool_             = std::move(other.pool_);
+            executor_         = other.executor_;
+            priority_         = other.priority_;
+            scheduling_       = std::move(other.scheduling_);
+
+            deadline_   = other.deadline_.load();
+            misses_     = other.misses_.load();
+            lastMiss_   = other.lastMiss_.load();
+            cycles_     = other.cycles_.load();
+            skippable_        = std::move(other.skippable_);
+            lastDurations_    = std::move(other.lastDurations_);
 
             if ( running ) execute();
 
@@ -57,31 +141,293 @@ namespace NaoFramework {
 
             log( "Adding new module: " + module->getName() );
             // First we get the name
-            indices_[module->getName()] = modules_.size()-1;
+            indices_[module->getName()] = modules_.size();
             // And at the end we move it away
             modules_.push_back(std::move(module));
+            {
+                std::lock_guard<std::mutex> lock(namesMutex_);
+                names_.push_back(modules_.back()->getName());
+            }
+            moduleStatistics_.emplace_back();
+            dependencies_.emplace_back();
+            skippable_.push_back(false);
+            lastDurations_.emplace_back(0);
+            updateStages();
+
+            if ( running ) execute();
+        }
+
+        void BrainWave::addModule(std::unique_ptr<Modules::ModuleInterface> && module, const Comm::Dependencies & dependencies) {
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( "Adding new module: " + module->getName() );
+            indices_[module->getName()] = modules_.size();
+            modules_.push_back(std::move(module));
+            {
+                std::lock_guard<std::mutex> lock(namesMutex_);
+                names_.push_back(modules_.back()->getName());
+            }
+            moduleStatistics_.emplace_back();
+            dependencies_.emplace_back(new Comm::Dependencies(dependencies));
+            skippable_.push_back(false);
+            lastDurations_.emplace_back(0);
+            updateStages();
+
+            if ( running ) execute();
+        }
+
+        bool BrainWave::updateModule(const std::string & module, const ModuleUpdate & update) {
+            auto it = indices_.find(module);
+            if ( it == std::end(indices_) ) return false;
+            auto i = it->second;
+
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( "Updating module: " + module );
+            try {
+                auto dependencies = update(*modules_[i], dependencies_[i].get());
+                dependencies_[i].reset(new Comm::Dependencies(std::move(dependencies)));
+                updateStages();
+            }
+            catch ( ... ) {
+                if ( running ) execute();
+                throw;
+            }
 
             if ( running ) execute();
+            return true;
+        }
+
+        void BrainWave::updateStages() {
+            stages_.clear();
+            // stage[i] is the stage of the i-th module. Each module goes right after
+            // the last stage containing a module it must follow. Modules with unknown
+            // dependencies must follow, and be followed by, everything.
+            std::vector<size_t> stage(modules_.size());
+            for ( size_t i = 0; i < modules_.size(); ++i ) {
+                size_t s = 0;
+                for ( size_t j = 0; j < i; ++j ) {
+                    bool conflict = !dependencies_[i] || !dependencies_[j] ||
+                                    dependencies_[i]->conflictsWith(*dependencies_[j]);
+                    if ( conflict && stage[j] + 1 > s ) s = stage[j] + 1;
+                }
+
+                stage[i] = s;
+                if ( s == stages_.size() ) stages_.emplace_back();
+                stages_[s].push_back(i);
+            }
         }
 
         void BrainWave::launchWave() {
             log( "## Wave running.");
-            while ( running_.load(std::memory_order_relaxed) ) {
-                for ( auto & p : modules_ )
-                    p->execute(); 
+            applyScheduling();
+            rescheduled_ = false;
+            auto deadline = Clock::now();
+            Comm::Trigger * watched = nullptr;
+            unsigned long seen = 0;
+            while ( true ) {
+                // This is the cycle boundary, where we stop while others change the wave.
+                if ( !running_.load(std::memory_order_acquire) ) {
+                    if ( !park() ) break;
+                    // Time went on while we were parked, so we start a fresh schedule.
+                    deadline = Clock::now();
+                    watched = nullptr;
+                }
+
+                // A replayed wave is driven by its recording, which provides the data that
+                // notified the trigger while recording, so waiting would never end.
+                auto trigger = replayer_.load(std::memory_order_acquire) ? nullptr : trigger_.load(std::memory_order_acquire);
+                if ( trigger ) {
+                    // Only notifications arrived after we started watching count.
+                    if ( trigger != watched ) {
+                        watched = trigger;
+                        seen = trigger->getCount();
+                    }
+                    auto count = trigger->waitFor(seen, triggerTimeout);
+                    if ( count == seen ) continue;
+
+                    seen = count;
+                    deadline = Clock::now();
+                }
+                else if ( watched ) {
+                    watched = nullptr;
+                    deadline = Clock::now();
+                }
+
+                runCycle(false);
+
+                std::chrono::microseconds period(period_.load(std::memory_order_relaxed));
+                if ( period.count() == 0 ) continue;
+
+                deadline += period;
+                auto now = Clock::now();
+                if ( now > deadline ) {
+                    overruns_.fetch_add(1, std::memory_order_relaxed);
+                    logf( Log::Warning, "Cycle overrun by %1% us.",
+                          std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count() );
+                    // Don't try to catch up, just restart the schedule from here.
+                    deadline = now;
+                }
+                else sleepUntil(deadline);
             }
             log( "## Wave quitting.");
         }
 
+        void BrainWave::runCycle(bool simulated) {
+            if ( resetStatistics_.load(std::memory_order_acquire) ) {
+                for ( auto & stats : moduleStatistics_ ) stats.reset();
+                cycleStatistics_->reset();
+                resetStatistics_.store(false, std::memory_order_release);
+            }
+
+            auto cycleStart = Clock::now();
+            cycleStart_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(cycleStart.time_since_epoch()).count(),
+                              std::memory_order_relaxed);
+            auto cycle = cycles_.fetch_add(1, std::memory_order_release) + 1;
+            inCycle_.store(true, std::memory_order_release);
+
+            auto replayer = replayer_.load(std::memory_order_acquire);
+            if ( replayer ) replayer->provide(cycle);
+
+            // Simulations run on the calling thread only, so that runs are repeatable.
+            if ( simulated || (!pool_ && !executor_) ) {
+                for ( size_t i = 0; i < modules_.size(); ++i )
+                    runModule(i);
+            }
+            else {
+                for ( auto & stage : stages_ ) {
+                    if ( stage.size() == 1 ) runModule(stage[0]);
+                    else if ( executor_ ) executor_->run(stage.size(), [this, &stage](size_t i){ runModule(stage[i]); }, priority_);
+                    else pool_->run(stage.size(), [this, &stage](size_t i){ runModule(stage[i]); });
+                }
+            }
+            auto cycleEnd = Clock::now();
+            inCycle_.store(false, std::memory_order_release);
+            currentModule_.store(-1, std::memory_order_relaxed);
+            cycleStatistics_->record(cycleEnd - cycleStart);
+
+            std::chrono::microseconds limit(deadline_.load(std::memory_order_relaxed));
+            // Deadlines are about wall time, which means nothing to a simulation, and
+            // skipping modules because of it would make runs differ.
+            catchingUp_ = !simulated && limit.count() != 0 && cycleEnd - cycleStart > limit;
+            if ( catchingUp_ ) recordMiss(cycleEnd - cycleStart);
+        }
+
+        bool BrainWave::simulateCycle() {
+            // The thread is parked, so the wave is ours until it is executed again.
+            if ( running_.load(std::memory_order_acquire) ) return false;
+            runCycle(true);
+            return true;
+        }
+
+        // Applies a scheduling to the calling thread, and returns what could not be applied.
+        static std::string applyScheduling(const BrainWave::Scheduling & scheduling) {
+            std::string errors;
+            auto self = pthread_self();
+
+            if ( !scheduling.cpus.empty() ) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for ( auto cpu : scheduling.cpus ) CPU_SET(cpu, &set);
+                int error = pthread_setaffinity_np(self, sizeof(set), &set);
+                if ( error ) errors += std::string("Could not set CPU affinity: ") + std::strerror(error) + ". ";
+            }
+
+            int policy = SCHED_OTHER;
+            sched_param param;
+            param.sched_priority = 0;
+            if ( scheduling.policy != BrainWave::Scheduling::Default ) {
+                policy = scheduling.policy == BrainWave::Scheduling::Fifo ? SCHED_FIFO : SCHED_RR;
+                param.sched_priority = scheduling.priority;
+            }
+            int error = pthread_setschedparam(self, policy, &param);
+            if ( error ) errors += std::string("Could not set scheduling policy: ") + std::strerror(error) + ". ";
+            return errors;
+        }
+
+        void BrainWave::applyScheduling() {
+            auto errors = Core::applyScheduling(scheduling_);
+            if ( !errors.empty() ) log( errors, Log::Warning );
+        }
+
+        void BrainWave::makePool(unsigned workers) {
+            if ( !workers ) {
+                pool_.reset();
+                return;
+            }
+            // Modules of the wave run on the workers too, so they get the same scheduling. Workers
+            // may start after the wave is moved, so they get copies rather than the wave itself.
+            auto scheduling = scheduling_;
+            auto name = name_;
+            pool_.reset(new WorkerPool(workers, [scheduling, name](){
+                auto errors = Core::applyScheduling(scheduling);
+                if ( !errors.empty() ) Log::log(name, "BrainWave", "Worker: " + errors, Log::Warning);
+            }));
+        }
+
+        void BrainWave::runModule(size_t i) {
+            if ( catchingUp_ && skippable_[i] ) {
+                lastDurations_[i] = TimingStatistics::Duration(0);
+                return;
+            }
+            currentModule_.store(i, std::memory_order_release);
+
+            auto start = Clock::now();
+            modules_[i]->execute();
+            lastDurations_[i] = Clock::now() - start;
+            moduleStatistics_[i].record(lastDurations_[i]);
+        }
+
+        void BrainWave::recordMiss(TimingStatistics::Duration cycle) {
+            size_t slowest = 0;
+            for ( size_t i = 1; i < lastDurations_.size(); ++i )
+                if ( lastDurations_[i] > lastDurations_[slowest] ) slowest = i;
+
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            if ( lastDurations_.empty() ) return;
+            lastMiss_.store(slowest, std::memory_order_relaxed);
+
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+            logf( Log::Warning, "Deadline missed, cycle took %1% us, slowest module was %2% with %3% us.",
+                  duration_cast<microseconds>(cycle).count(), modules_[slowest]->getName(),
+                  duration_cast<microseconds>(lastDurations_[slowest]).count() );
+        }
+
+        bool BrainWave::park() {
+            std::unique_lock<std::mutex> lock(controlMutex_);
+            log( "## Wave parked.");
+            parked_ = true;
+            control_.notify_all();
+            control_.wait(lock, [this](){ return quitting_ || running_.load(std::memory_order_relaxed); });
+            if ( quitting_ ) return false;
+
+            parked_ = false;
+            if ( rescheduled_ ) {
+                applyScheduling();
+                rescheduled_ = false;
+            }
+            log( "## Wave resumed.");
+            return true;
+        }
+
         void BrainWave::execute() {
             log( "Execute?");
             if ( running_.load(std::memory_order_acquire) ) return;
             log( "OK");
 
+            std::lock_guard<std::mutex> lock(controlMutex_);
             running_.store(true, std::memory_order_release);
 
-            // Run thread
+            if ( wave_.joinable() ) {
+                control_.notify_all();
+                return;
+            }
+            // The thread is only created once, then it parks when paused.
             log( "Opening thread.");
+            parked_ = false;
             wave_ = std::thread(&BrainWave::launchWave, this);
             log( "Thread opened.");
         }
@@ -91,18 +437,191 @@ namespace NaoFramework {
             if ( !running_.load(std::memory_order_acquire) ) return;
             log( "OK");
 
+            // The thread parks at the end of its current cycle.
+            std::unique_lock<std::mutex> lock(controlMutex_);
             running_.store(false, std::memory_order_release);
+            control_.wait(lock, [this](){ return parked_; });
+            log( "Parked");
+        }
+
+        void BrainWave::stop() {
+            if ( !wave_.joinable() ) return;
+
+            {
+                std::lock_guard<std::mutex> lock(controlMutex_);
+                running_.store(false, std::memory_order_release);
+                quitting_ = true;
+            }
+            control_.notify_all();
 
-            // Thread join
             log( "Joining");
             wave_.join();
             log( "Joined");
+
+            quitting_ = false;
+            parked_ = true;
         }
 
         bool BrainWave::isRunning() const {
             return running_.load(std::memory_order_acquire);
         }
 
+        void BrainWave::setPeriod(std::chrono::microseconds period) {
+            log( "Setting period to " + std::to_string(period.count()) + " us.");
+            period_.store(period.count(), std::memory_order_relaxed);
+        }
+
+        void BrainWave::setTrigger(Comm::Trigger * trigger) {
+            log( trigger ? "Setting trigger." : "Removing trigger." );
+            trigger_.store(trigger, std::memory_order_release);
+        }
+
+        void BrainWave::setReplayer(Comm::Replayer * replayer) {
+            log( replayer ? "Setting replayer." : "Removing replayer." );
+            replayer_.store(replayer, std::memory_order_release);
+        }
+
+        Comm::Trigger * BrainWave::getTrigger() const {
+            return trigger_.load(std::memory_order_acquire);
+        }
+
+        Comm::Replayer * BrainWave::getReplayer() const {
+            return replayer_.load(std::memory_order_acquire);
+        }
+
+        Executor * BrainWave::getExecutor() const {
+            return executor_;
+        }
+
+        std::chrono::microseconds BrainWave::getPeriod() const {
+            return std::chrono::microseconds(period_.load(std::memory_order_relaxed));
+        }
+
+        unsigned long BrainWave::getOverruns() const {
+            return overruns_.load(std::memory_order_relaxed);
+        }
+
+        void BrainWave::setParallel(unsigned workers) {
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( "Setting parallel workers to " + std::to_string(workers) );
+            makePool(workers);
+            executor_ = nullptr;
+
+            if ( running ) execute();
+        }
+
+        void BrainWave::setExecutor(Executor * executor, Executor::Priority priority) {
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( executor ? "Setting shared executor with priority " + std::to_string(priority) : "Removing shared executor." );
+            pool_.reset();
+            executor_ = executor;
+            priority_ = priority;
+
+            if ( running ) execute();
+        }
+
+        void BrainWave::setDeadline(std::chrono::microseconds deadline) {
+            log( "Setting deadline to " + std::to_string(deadline.count()) + " us.");
+            deadline_.store(deadline.count(), std::memory_order_relaxed);
+        }
+
+        std::chrono::microseconds BrainWave::getDeadline() const {
+            return std::chrono::microseconds(deadline_.load(std::memory_order_relaxed));
+        }
+
+        unsigned long BrainWave::getDeadlineMisses() const {
+            return misses_.load(std::memory_order_relaxed);
+        }
+
+        std::string BrainWave::getLastMissOffender() const {
+            auto i = lastMiss_.load(std::memory_order_relaxed);
+            return i < 0 ? "" : modules_[i]->getName();
+        }
+
+        bool BrainWave::setSkippable(const std::string & module, bool skippable) {
+            auto it = indices_.find(module);
+            if ( it == std::end(indices_) ) return false;
+
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( module + (skippable ? " can now be skipped." : " can no longer be skipped.") );
+            skippable_[it->second] = skippable;
+
+            if ( running ) execute();
+            return true;
+        }
+
+        BrainWave::Heartbeat BrainWave::getHeartbeat() const {
+            Heartbeat h;
+            h.inCycle = inCycle_.load(std::memory_order_acquire);
+            h.cycles  = cycles_.load(std::memory_order_acquire);
+            h.start   = Clock::time_point(std::chrono::nanoseconds(cycleStart_.load(std::memory_order_relaxed)));
+
+            // Modules may be changed meanwhile by other threads, so we only look at their names.
+            auto i = currentModule_.load(std::memory_order_acquire);
+            std::lock_guard<std::mutex> lock(namesMutex_);
+            if ( h.inCycle && i >= 0 && static_cast<size_t>(i) < names_.size() ) h.module = names_[i];
+
+            return h;
+        }
+
+        const std::atomic<unsigned long> & BrainWave::getCycles() const {
+            return cycles_;
+        }
+
+        void BrainWave::setScheduling(const Scheduling & scheduling) {
+            bool running = isRunning();
+            if ( running ) pause();
+
+            log( "Setting scheduling policy " + std::to_string(scheduling.policy) +
+                 " with priority " + std::to_string(scheduling.priority) +
+                 " on " + std::to_string(scheduling.cpus.size()) + " CPUs." );
+            scheduling_ = scheduling;
+            rescheduled_ = true;
+            if ( pool_ ) makePool(pool_->getWorkers());
+
+            if ( running ) execute();
+        }
+
+        const BrainWave::Scheduling & BrainWave::getScheduling() const {
+            return scheduling_;
+        }
+
+        std::vector<std::vector<std::string>> BrainWave::getStages() const {
+            std::vector<std::vector<std::string>> stages;
+            for ( auto & stage : stages_ ) {
+                stages.emplace_back();
+                for ( auto i : stage ) stages.back().push_back(modules_[i]->getName());
+            }
+            return stages;
+        }
+
+        std::vector<std::pair<std::string, TimingStatistics::Summary>> BrainWave::getModuleStatistics() const {
+            std::vector<std::pair<std::string, TimingStatistics::Summary>> statistics;
+            for ( size_t i = 0; i < modules_.size(); ++i )
+                statistics.emplace_back(modules_[i]->getName(), moduleStatistics_[i].summarize());
+
+            return statistics;
+        }
+
+        TimingStatistics::Summary BrainWave::getCycleStatistics() const {
+            return cycleStatistics_->summarize();
+        }
+
+        void BrainWave::resetStatistics() {
+            if ( isRunning() ) {
+                resetStatistics_.store(true, std::memory_order_release);
+                return;
+            }
+            for ( auto & stats : moduleStatistics_ ) stats.reset();
+            cycleStatistics_->reset();
+        }
+
         const std::string & BrainWave::getName() const {
             return name_;
         }
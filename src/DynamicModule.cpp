@@ -2,7 +2,12 @@
 
 #include <stdexcept>
 
+#include <boost/filesystem/operations.hpp>
+
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace NaoFramework {
     namespace Modules {
@@ -12,61 +17,193 @@ namespace NaoFramework {
         #define TO_STRING(X) TO_STRING_2(X)
         #define FACTORY_NAME TO_STRING(NAO_FRAMEWORK_DYNAMIC_MODULE_FACTORY)
         #define DUMP_NAME    TO_STRING(NAO_FRAMEWORK_DYNAMIC_MODULE_DUMP)
-        // We need a separate function because names are set in ModuleInterface:
-        // we need to know the name of the module we are loading beforehand, but
-        // we can't assume it from the library filename.
-        std::unique_ptr<DynamicModule> makeDynamicModule(const std::string & moduleFilename,
-                                                         Comm::LocalBlackboardAdapter & comm,
-                                                         Comm::ExternalBlackboardAdapterMap & others)
-        {
-            // Load full library
-            void * dllModule = dlopen(moduleFilename.c_str(), RTLD_GLOBAL | RTLD_NOW);
+        using Clock = std::chrono::steady_clock;
+
+        // This loads a library, and finds the functions created by MODULE_EXPORT in it.
+        static void openLibrary(const std::string & moduleFilename, int flags, DynamicLibrary & library) {
+            auto start = Clock::now();
+            void * dllModule = dlopen(moduleFilename.c_str(), flags);
             if ( dllModule == nullptr ) throw std::runtime_error(dlerror());
+            auto opened = Clock::now();
 
             // Module maker
-            dynamicModuleFactory* factory = (dynamicModuleFactory*) dlsym(dllModule, FACTORY_NAME);
-            if ( factory == nullptr ) {
-                dlclose(dllModule);    
-                throw std::runtime_error(dlerror());
+            library.factory = (dynamicModuleFactory*) dlsym(dllModule, FACTORY_NAME);
+            if ( library.factory == nullptr ) {
+                std::string error = dlerror();
+                dlclose(dllModule);
+                throw std::runtime_error(error);
             }
             // We need to obtain this function now because we can't simply
             // create an instance we might not be able to delete!
-            dynamicModuleDump* moduleDeleter = (dynamicModuleDump*) dlsym(dllModule, DUMP_NAME);
-            if ( moduleDeleter == nullptr ) {
-                dlclose(dllModule);    
-                throw std::runtime_error(dlerror());
+            library.deleter = (dynamicModuleDump*) dlsym(dllModule, DUMP_NAME);
+            if ( library.deleter == nullptr ) {
+                std::string error = dlerror();
+                dlclose(dllModule);
+                throw std::runtime_error(error);
             }
+            library.dllModule   = dllModule;
+            library.openTime    = opened - start;
+            library.resolveTime = Clock::now() - opened;
+        }
+
+        // Records still queued by the module may point to format literals of its library.
+        static void closeLibrary(void * dllModule) {
+            Log::flush();
+            dlclose(dllModule);
+        }
+
+        // Modules report errors in their constructors by throwing either exceptions or
+        // registration errors, and we want a message either way.
+        static DynamicModuleInterface * construct(dynamicModuleFactory * factory,
+                                                  Comm::LocalBlackboardAdapter & comm,
+                                                  Comm::ExternalBlackboardAdapterMap & others)
+        {
+            try {
+                return factory(comm, others);
+            } catch ( std::exception & e ) {
+                throw std::runtime_error(e.what());
+            } catch ( ... ) {
+                throw std::runtime_error("the module constructor failed");
+            }
+        }
+
+        // Reading the whole file now means dlopen() finds it in the page cache.
+        static void prefetch(const std::string & moduleFilename) {
+            int fd = open(moduleFilename.c_str(), O_RDONLY | O_CLOEXEC);
+            if ( fd < 0 ) return; // dlopen() will report the error.
+
+            struct stat info;
+            if ( fstat(fd, &info) == 0 ) readahead(fd, 0, info.st_size);
+            close(fd);
+        }
+
+        DynamicLibrary openDynamicModule(const std::string & moduleFilename) {
+            DynamicLibrary library;
+            library.filename = moduleFilename;
+
+            auto start = Clock::now();
+            prefetch(moduleFilename);
+            library.readTime = Clock::now() - start;
+
+            // Load full library
+            openLibrary(moduleFilename, RTLD_GLOBAL | RTLD_NOW, library);
+
+            return library;
+        }
+
+        // We need a separate function because names are set in ModuleInterface:
+        // we need to know the name of the module we are loading beforehand, but
+        // we can't assume it from the library filename.
+        std::unique_ptr<DynamicModule> makeDynamicModule(const DynamicLibrary & library,
+                                                         Comm::LocalBlackboardAdapter & comm,
+                                                         Comm::ExternalBlackboardAdapterMap & others)
+        {
             // This is managed by the DynamicModule and it is actually deleted within
             // the dll, so it's ok that we don't wrap the pointer up because we don't want
             // to actually delete it ourselves.
             try {
-                DynamicModuleInterface* module = factory(comm, others);
+                DynamicModuleInterface* module = construct(library.factory, comm, others);
                 // One day we'll use make_unique...
                 return std::unique_ptr<DynamicModule>( 
-                            new DynamicModule("Dynamic" + module->getName(), dllModule, module, moduleDeleter) );
-            } catch ( std::exception e ) {
-                dlclose(dllModule);
-                throw e;
+                            new DynamicModule("Dynamic" + module->getName(), library.filename,
+                                              library.dllModule, module, library.factory, library.deleter) );
+            } catch ( std::runtime_error & ) {
+                closeLibrary(library.dllModule);
+                throw;
             }
         }
 
+        std::unique_ptr<DynamicModule> makeDynamicModule(const std::string & moduleFilename,
+                                                         Comm::LocalBlackboardAdapter & comm,
+                                                         Comm::ExternalBlackboardAdapterMap & others)
+        {
+            return makeDynamicModule(openDynamicModule(moduleFilename), comm, others);
+        }
+
+        void DynamicModule::reload(const std::string & moduleFilename,
+                                   Comm::LocalBlackboardAdapter & comm,
+                                   Comm::ExternalBlackboardAdapterMap & others,
+                                   const std::function<void()> & rollback)
+        {
+            namespace fs = boost::filesystem;
+            // dlopen() returns the library already loaded when given the same filename,
+            // so we load a copy. RTLD_DEEPBIND makes the copy use its own symbols rather
+            // than those of the old library, which are already in the global scope.
+            boost::system::error_code error;
+            auto copy = fs::temp_directory_path() / fs::unique_path("%%%%-%%%%-" + fs::path(moduleFilename).filename().string());
+            fs::copy_file(moduleFilename, copy, error);
+            if ( error ) throw std::runtime_error("Could not copy " + moduleFilename + ": " + error.message());
+
+            DynamicLibrary library;
+            try {
+                openLibrary(copy.string(), RTLD_LOCAL | RTLD_NOW | RTLD_DEEPBIND, library);
+            } catch ( std::runtime_error & ) {
+                fs::remove(copy, error);
+                throw;
+            }
+            fs::remove(copy, error); // The library stays mapped.
+            auto dllModule      = library.dllModule;
+            auto factory        = library.factory;
+            auto moduleDeleter  = library.deleter;
+
+            log("Reloading from " + moduleFilename);
+            if (module_) moduleDeleter_(&module_);
+            module_ = nullptr;
+
+            std::string failure;
+            try {
+                auto module = construct(factory, comm, others);
+                if ( "Dynamic" + module->getName() == name_ ) {
+                    retiredModules_.push_back(dllModule_);
+                    filename_       = moduleFilename;
+                    dllModule_      = dllModule;
+                    module_         = module;
+                    moduleFactory_  = factory;
+                    moduleDeleter_  = moduleDeleter;
+                    log("Reloaded.");
+                    return;
+                }
+                failure = "the new module is called " + module->getName();
+                moduleDeleter(&module);
+            } catch ( std::runtime_error & e ) {
+                failure = e.what();
+            }
+            // The new module may have created slots before failing, so its library must stay.
+            retiredModules_.push_back(dllModule);
+
+            log("Reload failed, restoring the old module: " + failure, Log::Warning);
+            if ( rollback ) rollback();
+            try {
+                module_ = construct(moduleFactory_, comm, others);
+            } catch ( std::runtime_error & e ) {
+                failure += ", and the old module could not be restored: " + std::string(e.what());
+            }
+            throw std::runtime_error(failure);
+        }
+
         #undef FACTORY_NAME 
         #undef DUMP_NAME    
         #undef TO_STRING
         #undef TO_STRING_2
 
-        DynamicModule::DynamicModule(std::string name, void * dllModule, DynamicModuleInterface * module, dynamicModuleDump * deleter) :
+        DynamicModule::DynamicModule(std::string name, std::string filename, void * dllModule, DynamicModuleInterface * module,
+                                     dynamicModuleFactory * factory, dynamicModuleDump * deleter) :
                                                                 DynamicModuleInterface(name),
+                                                                filename_(filename),
                                                                 dllModule_(dllModule),
                                                                 module_(module),
+                                                                moduleFactory_(factory),
                                                                 moduleDeleter_(deleter) {}
 
 
         DynamicModule::DynamicModule(DynamicModule && other) : 
                                                         DynamicModuleInterface(std::move(other)),
+                                                        filename_(std::move(other.filename_)),
                                                         dllModule_(other.dllModule_),
                                                         module_(other.module_),
-                                                        moduleDeleter_(other.moduleDeleter_)
+                                                        moduleFactory_(other.moduleFactory_),
+                                                        moduleDeleter_(other.moduleDeleter_),
+                                                        retiredModules_(std::move(other.retiredModules_))
         {
             other.dllModule_        = nullptr;
             other.module_           = nullptr;
@@ -76,11 +213,15 @@ namespace NaoFramework {
             DynamicModuleInterface::operator=(std::move(other));
 
             if (module_)    moduleDeleter_(&module_);
-            if (dllModule_) dlclose(dllModule_);
+            if (dllModule_) closeLibrary(dllModule_);
+            for ( auto dll : retiredModules_ ) closeLibrary(dll);
 
+            filename_               = std::move(other.filename_);
             dllModule_              = other.dllModule_;
             module_                 = other.module_;
+            moduleFactory_          = other.moduleFactory_;
             moduleDeleter_          = other.moduleDeleter_;
+            retiredModules_         = std::move(other.retiredModules_);
 
             other.dllModule_        = nullptr;
             other.module_           = nullptr;
@@ -92,12 +233,18 @@ namespace NaoFramework {
             log("Deleting module..");
             if (module_)    moduleDeleter_(&module_);
             log("Dropping dll..");
-            if (dllModule_) dlclose(dllModule_);
+            if (dllModule_) closeLibrary(dllModule_);
+            for ( auto dll : retiredModules_ ) closeLibrary(dll);
             log("Resources cleaned.");
         }
 
         void DynamicModule::execute() {
-            module_->execute();
+            // The module is only missing if a failed reload could not restore it.
+            if (module_) module_->execute();
+        }
+
+        const std::string & DynamicModule::getFilename() const {
+            return filename_;
         }
     }
 }
@@ -0,0 +1,134 @@
+#include <NaoFramework/Core/Executor.hpp>
+
+#include <algorithm>
+
+namespace NaoFramework {
+    namespace Core {
+        Executor::Executor(unsigned workers) : nextWorker_(0), queued_(0), quitting_(false) {
+            for ( unsigned i = 0; i < workers; ++i )
+                workers_.emplace_back(new Worker());
+            // Threads are started once all queues exist, as they steal from each other.
+            for ( unsigned i = 0; i < workers; ++i )
+                threads_.emplace_back(&Executor::work, this, i);
+        }
+
+        Executor::~Executor() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                quitting_ = true;
+            }
+            wake_.notify_all();
+            for ( auto & thread : threads_ ) thread.join();
+        }
+
+        void Executor::run(size_t count, const Task & task, Priority priority) {
+            if ( count == 0 ) return;
+
+            Batch batch;
+            batch.task = &task;
+            batch.count = count;
+            batch.next.store(0, std::memory_order_relaxed);
+            batch.active.store(0, std::memory_order_relaxed);
+
+            // One token per additional thread that could help, we run tasks too.
+            size_t tokens = std::min<size_t>(count - 1, workers_.size());
+            if ( tokens ) {
+                // Counted before pushing, so that the count never goes below the real one.
+                queued_.fetch_add(tokens, std::memory_order_seq_cst);
+                for ( size_t i = 0; i < tokens; ++i ) {
+                    auto & worker = *workers_[nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    worker.queues[priority].push_back(&batch);
+                }
+                { std::lock_guard<std::mutex> lock(sleepMutex_); }
+                wake_.notify_all();
+            }
+
+            runTasks(&batch);
+
+            // All tasks have been claimed: tokens still queued are useless, and
+            // once those are gone we only need to wait for workers still running.
+            revoke(&batch);
+            std::unique_lock<std::mutex> lock(batch.mutex);
+            batch.done.wait(lock, [&batch](){ return batch.active.load(std::memory_order_acquire) == 0; });
+        }
+
+        unsigned Executor::getWorkers() const {
+            return threads_.size();
+        }
+
+        void Executor::work(unsigned id) {
+            while ( true ) {
+                auto batch = pop(id);
+                if ( batch ) {
+                    join(batch);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleepMutex_);
+                wake_.wait(lock, [this](){ return quitting_ || queued_.load(std::memory_order_seq_cst) > 0; });
+                if ( quitting_ ) return;
+            }
+        }
+
+        Executor::Batch * Executor::pop(unsigned id) {
+            for ( unsigned p = 0; p < PrioritiesNumber; ++p ) {
+                // Our own queue first, from the front..
+                {
+                    auto & worker = *workers_[id];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    auto & queue = worker.queues[p];
+                    if ( !queue.empty() ) {
+                        auto batch = queue.front();
+                        queue.pop_front();
+                        batch->active.fetch_add(1, std::memory_order_relaxed);
+                        queued_.fetch_sub(1, std::memory_order_relaxed);
+                        return batch;
+                    }
+                }
+                // ..then we steal from the back of the others.
+                for ( unsigned i = 1; i < workers_.size(); ++i ) {
+                    auto & worker = *workers_[(id + i) % workers_.size()];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    auto & queue = worker.queues[p];
+                    if ( !queue.empty() ) {
+                        auto batch = queue.back();
+                        queue.pop_back();
+                        batch->active.fetch_add(1, std::memory_order_relaxed);
+                        queued_.fetch_sub(1, std::memory_order_relaxed);
+                        return batch;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        void Executor::join(Batch * batch) {
+            runTasks(batch);
+
+            // The batch lives in the stack of its caller, which may return as soon as
+            // it sees no active workers, so we must not touch it after unlocking.
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            if ( batch->active.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+                batch->done.notify_one();
+        }
+
+        void Executor::revoke(Batch * batch) {
+            // Tokens are only taken under the queue locks, so once this is done
+            // no worker can join the batch anymore.
+            for ( auto & worker : workers_ ) {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                for ( auto & queue : worker->queues ) {
+                    auto it = std::remove(std::begin(queue), std::end(queue), batch);
+                    queued_.fetch_sub(std::distance(it, std::end(queue)), std::memory_order_relaxed);
+                    queue.erase(it, std::end(queue));
+                }
+            }
+        }
+
+        void Executor::runTasks(Batch * batch) {
+            size_t i;
+            while ( (i = batch->next.fetch_add(1, std::memory_order_relaxed)) < batch->count )
+                (*batch->task)(i);
+        }
+    }
+}
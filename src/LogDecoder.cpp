@@ -0,0 +1,159 @@
+#include <NaoFramework/Log/BinaryLog.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <ctime>
+#include <cstdio>
+#include <unordered_map>
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace NaoFramework::Log;
+
+/*
+ * Reads the single file logs, and either prints them or splits them into a
+ * file for each client, in the same layout as the text sinks.
+ */
+class Output {
+    public:
+        Output(std::string client, std::string folder) : client_(std::move(client)), folder_(std::move(folder)) {}
+
+        void write(const std::string & client, const std::string & date, const std::string & priority, const std::string & message) {
+            if ( folder_.empty() ) {
+                if ( client_.empty() || client == client_ )
+                    std::cout << '[' << date << "][" << priority << "][" << client << "] " << message << '\n';
+                return;
+            }
+            getFile(client) << '[' << date << "][" << priority << "] " << message << '\n';
+        }
+
+        // Lines of a text message which contained newlines.
+        void writeContinuation(const std::string & line) {
+            if ( folder_.empty() ) {
+                if ( client_.empty() || last_ == client_ ) std::cout << line << '\n';
+                return;
+            }
+            if ( !last_.empty() ) getFile(last_) << line << '\n';
+        }
+
+    private:
+        std::string client_;
+        std::string folder_;
+        std::string last_;
+        std::unordered_map<std::string, std::unique_ptr<std::ofstream>> files_;
+
+        std::ofstream & getFile(const std::string & client) {
+            last_ = client;
+            auto & file = files_[client];
+            if ( !file ) {
+                boost::filesystem::path path(folder_ + '/' + client);
+                boost::filesystem::create_directories(path.parent_path());
+                file.reset(new std::ofstream(path.string()));
+            }
+            return *file;
+        }
+};
+
+static bool splitBinary(const std::string & log, Output & output, bool split) {
+    const char * data = log.data() + sizeof(BinaryLog::Magic);
+    const char * end  = log.data() + log.size();
+
+    std::unordered_map<uint16_t, std::string> clients;
+    std::unordered_map<uint32_t, std::string> formats;
+
+    uint8_t type;
+    while ( BinaryLog::get(data, end, type) ) {
+        bool valid;
+        switch ( type ) {
+            case BinaryLog::ClientEntry: {
+                uint16_t id;
+                valid = BinaryLog::get(data, end, id) && BinaryLog::getString(data, end, clients[id]);
+                break;
+            }
+            case BinaryLog::FormatEntry: {
+                uint32_t id;
+                valid = BinaryLog::get(data, end, id) && BinaryLog::getString(data, end, formats[id]);
+                break;
+            }
+            case BinaryLog::MessageEntry: {
+                int64_t time; uint16_t client; uint8_t priority; uint32_t format;
+                std::string arguments;
+                valid = BinaryLog::get(data, end, time) && BinaryLog::get(data, end, client) &&
+                        BinaryLog::get(data, end, priority) && BinaryLog::get(data, end, format) &&
+                        BinaryLog::getString(data, end, arguments);
+                if ( !valid ) break;
+
+                std::time_t seconds = time / 1000000000;
+                char date[40];
+                auto size = std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+                // Split files keep the layout of the text sinks.
+                if ( !split ) std::snprintf(date + size, sizeof(date) - size, ".%06ld", static_cast<long>(time % 1000000000 / 1000));
+
+                output.write(clients[client], date, BinaryLog::getPriorityName(static_cast<MessagePriority>(priority)),
+                             BinaryLog::format(formats[format], arguments));
+                break;
+            }
+            default:
+                valid = false;
+        }
+        if ( !valid ) {
+            // A log cut short by a crash ends with a partial entry.
+            std::cerr << "Log truncated or corrupted at byte " << (data - log.data()) << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+static void splitText(std::istream & log, Output & output) {
+    // Lines are "[date][priority][client] message".
+    std::string line;
+    while ( std::getline(log, line) ) {
+        size_t dateEnd, priorityEnd, clientEnd;
+        if ( line.empty() || line[0] != '[' ||
+             (dateEnd     = line.find("][")) == std::string::npos ||
+             (priorityEnd = line.find("][", dateEnd + 2)) == std::string::npos ||
+             (clientEnd   = line.find("] ", priorityEnd + 2)) == std::string::npos ) {
+            output.writeContinuation(line);
+            continue;
+        }
+        output.write(line.substr(priorityEnd + 2, clientEnd - priorityEnd - 2),
+                     line.substr(1, dateEnd - 1),
+                     line.substr(dateEnd + 2, priorityEnd - dateEnd - 2),
+                     line.substr(clientEnd + 2));
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    bool split = argc == 4 && std::string(argv[1]) == "-s";
+    if ( !split && (argc < 2 || argc > 3) ) {
+        std::cerr << "Usage: " << argv[0] << " log.nlog|log.txt [client]\n"
+                  << "       " << argv[0] << " -s folder log.nlog|log.txt\n"
+                  << "Prints a binary or shared log, or splits it into a file for each client.\n";
+        return 1;
+    }
+    const char * filename = split ? argv[3] : argv[1];
+    std::ifstream file(filename, std::ios::binary);
+    if ( !file ) {
+        std::cerr << "Could not open " << filename << '\n';
+        return 1;
+    }
+    Output output(!split && argc == 3 ? argv[2] : "", split ? argv[2] : "");
+
+    char magic[sizeof(BinaryLog::Magic)] = {};
+    file.read(magic, sizeof(magic));
+    if ( file.gcount() == sizeof(magic) && !std::memcmp(magic, BinaryLog::Magic, sizeof(magic)) ) {
+        std::string log(magic, sizeof(magic));
+        log.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return splitBinary(log, output, split) ? 0 : 1;
+    }
+
+    file.clear();
+    file.seekg(0);
+    splitText(file, output);
+    return 0;
+}
@@ -1,10 +1,20 @@
 #include <NaoFramework/Log/Frontend.hpp>
+#include <NaoFramework/Log/RingBuffer.hpp>
+#include <NaoFramework/Log/BinaryLog.hpp>
 
 #include <ostream>
 #include <fstream>
 #include <iomanip>
+#include <cstring>
+#include <algorithm>
 #include <unordered_map>
+#include <vector>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 // Normally we would use std::shared_ptr
 // But this library does not accept it
@@ -21,6 +31,8 @@
 #include <boost/log/expressions.hpp>
 #include <boost/log/attributes.hpp>
 #include <boost/log/support/date_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
 
 // Some aliasing convenience
 namespace logging = boost::log;
@@ -43,20 +55,305 @@ namespace NaoFramework {
         static std::mutex availableSinksMutex;
 
         static std::string logFolder;
+        static LogFormat logFormat = TextFormat;
+        // Used in SharedFormat instead of a sink per client.
+        static boost::shared_ptr<TextSink> sharedSink;
+        static std::atomic<int> minimumPriority(Trace);
+
+        /*
+         * A channel holds everything needed to write the messages of a client, so that
+         * nothing has to be built for each message. Channels are created by the clients,
+         * but their logger is only used by the writing thread.
+         */
+        class Channel {
+            public:
+                Channel(std::string name) : name(std::move(name)), binaryId(-1) {
+                    logger.add_attribute("Client", attrs::constant< std::string >(this->name));
+                    // This replaces the global clock, which would give the time of writing.
+                    logger.add_attribute("TimeStamp", time);
+                }
+
+                const std::string name;
+
+                src::severity_logger< logging::trivial::severity_level > logger;
+                // Without a mutex, as only the writing thread sets it.
+                attrs::mutable_constant< boost::posix_time::ptime > time{boost::posix_time::ptime()};
+                int binaryId;
+        };
+
+        // A message waiting to be written by the background thread. Messages logged
+        // with logf have a format and encoded arguments instead of a text.
+        struct Record {
+            ChannelPointer channel;
+            std::string message;
+            MessagePriority priority;
+            std::chrono::system_clock::time_point time;
+            const char * format;
+            std::string arguments;
+        };
+
+        // Plain messages are written to the binary log as their only argument.
+        static const char plainFormat[] = "%1%";
+
+        // Each thread logs into its own queue, so that logging threads never contend,
+        // and never wait for the disk. When a queue is full, messages are dropped.
+        struct ThreadQueue {
+            RingBuffer<Record, 1024> records;
+            std::atomic<unsigned long> dropped;
+            std::atomic<bool> abandoned;    // Its thread has exited.
+
+            ThreadQueue() : dropped(0), abandoned(false) {}
+        };
+
+        /*
+         * This class owns the thread which writes all queued messages to the sinks.
+         *
+         * The thread polls the queues, since waking it up from logging threads would
+         * cost them a system call for each message.
+         */
+        class RecordWriter {
+            public:
+                RecordWriter() : running_(false), quitting_(false), passes_(0), binary_(false) {
+                    // The Boost.Log singletons we use must be destroyed after we stop writing,
+                    // so they must be constructed before us.
+                    logging::core::get();
+                    logging::attribute_name("Client");
+                    logging::attribute_name("TimeStamp");
+                    // Severity loggers keep the severity of the record in a lazily created TLS key.
+                    src::severity_logger< logging::trivial::severity_level > slg;
+                    slg.open_record(keywords::severity = logging::trivial::info);
+                }
+                ~RecordWriter() { stop(); }
+
+                void start() {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if ( running_ ) return;
+                    running_ = true;
+                    thread_ = std::thread(&RecordWriter::run, this);
+                }
+
+                void stop() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if ( !running_ ) return;
+                        quitting_ = true;
+                    }
+                    wake_.notify_all();
+                    thread_.join();
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    running_ = false;
+                }
+
+                // Must be called before starting.
+                void setBinary(const std::string & filename) {
+                    binary_ = true;
+                    binaryFile_.open(filename, std::ios::binary | std::ios::trunc);
+                    binaryFile_.write(BinaryLog::Magic, sizeof(BinaryLog::Magic));
+                }
+
+                void add(std::shared_ptr<ThreadQueue> queue) {
+                    std::lock_guard<std::mutex> lock(queuesMutex_);
+                    queues_.push_back(std::move(queue));
+                }
+
+                // Waits until all messages logged before the call have been written.
+                void flush() {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    if ( !running_ || std::this_thread::get_id() == thread_.get_id() ) return;
+                    // The pass in progress may have already skipped our queue, so we wait for the next one.
+                    auto target = passes_ + 2;
+                    wake_.notify_all();
+                    written_.wait(lock, [this, target](){ return passes_ >= target || !running_ || quitting_; });
+                }
+
+            private:
+                static constexpr std::chrono::milliseconds pollInterval{5};
+
+                std::vector<std::shared_ptr<ThreadQueue>> queues_;
+                std::vector<std::shared_ptr<ThreadQueue>> snapshot_;
+                std::mutex queuesMutex_;
+
+                bool running_;
+                bool quitting_;
+                unsigned long passes_;
+                std::mutex mutex_;
+                std::condition_variable wake_;
+                std::condition_variable written_;
+                std::thread thread_;
+
+                // Only used by the writing thread.
+                bool binary_;
+                std::ofstream binaryFile_;
+                std::unordered_map<std::string, uint16_t> clientIds_;
+                // Keyed by content, as the same address may hold another format once a library is closed.
+                std::unordered_map<std::string, uint32_t> formatIds_;
+                std::string formatKey_;
+                std::string entry_;
+
+                void run() {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while ( true ) {
+                        bool quitting = quitting_;
+                        lock.unlock();
+                        bool wrote = writeAll();
+                        lock.lock();
+
+                        ++passes_;
+                        written_.notify_all();
+                        if ( quitting ) break;
+                        #if NAO_DEBUG
+                        if ( binary_ && wrote ) binaryFile_.flush();
+                        #endif
+                        if ( !wrote ) wake_.wait_for(lock, pollInterval);
+                    }
+                }
+
+                bool writeAll() {
+                    {
+                        std::lock_guard<std::mutex> lock(queuesMutex_);
+                        snapshot_ = queues_;
+                        // Queues of exited threads are dropped once empty.
+                        queues_.erase(std::remove_if(std::begin(queues_), std::end(queues_),
+                                          [](const std::shared_ptr<ThreadQueue> & q){
+                                              return q->abandoned.load(std::memory_order_acquire) && q->records.empty();
+                                          }), std::end(queues_));
+                    }
+                    bool wrote = false;
+                    Record record;
+                    for ( auto & queue : snapshot_ ) {
+                        while ( queue->records.pop(record) ) {
+                            write(record);
+                            wrote = true;
+                        }
+                        auto dropped = queue->dropped.exchange(0, std::memory_order_relaxed);
+                        if ( dropped )
+                            write({makeChannel("Log", ""), "Dropped " + std::to_string(dropped) + " messages from a thread logging too fast.",
+                                   Warning, std::chrono::system_clock::now(), nullptr, ""});
+                    }
+                    snapshot_.clear();
+                    return wrote;
+                }
+
+                void write(const Record & record) {
+                    if ( binary_ ) writeBinary(record);
+                    else writeText(record);
+                }
+
+                static void writeText(const Record & record) {
+                    using namespace logging::trivial;
+                    auto & channel = *record.channel;
+                    channel.time.set(toLocalTime(record.time));
+                    BOOST_LOG_SEV(channel.logger, static_cast<severity_level>(record.priority))
+                        << ( record.format ? BinaryLog::format(record.format, record.arguments) : record.message );
+                }
+
+                void writeBinary(const Record & record) {
+                    using namespace BinaryLog;
+                    entry_.clear();
+
+                    auto & channel = *record.channel;
+                    if ( channel.binaryId < 0 ) {
+                        auto client = clientIds_.find(channel.name);
+                        if ( client == std::end(clientIds_) ) {
+                            client = clientIds_.emplace(channel.name, clientIds_.size()).first;
+                            put<uint8_t>(entry_, ClientEntry);
+                            put<uint16_t>(entry_, client->second);
+                            putString(entry_, channel.name.data(), channel.name.size());
+                        }
+                        channel.binaryId = client->second;
+                    }
+                    formatKey_.assign(record.format ? record.format : plainFormat);
+                    auto formatId = formatIds_.find(formatKey_);
+                    if ( formatId == std::end(formatIds_) ) {
+                        formatId = formatIds_.emplace(formatKey_, formatIds_.size()).first;
+                        put<uint8_t>(entry_, FormatEntry);
+                        put<uint32_t>(entry_, formatId->second);
+                        putString(entry_, formatKey_.data(), formatKey_.size());
+                    }
+
+                    put<uint8_t>(entry_, MessageEntry);
+                    put<int64_t>(entry_, std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count());
+                    put<uint16_t>(entry_, channel.binaryId);
+                    put<uint8_t>(entry_, record.priority);
+                    put<uint32_t>(entry_, formatId->second);
+                    if ( record.format ) {
+                        putString(entry_, record.arguments.data(), record.arguments.size());
+                    }
+                    else {
+                        // Encoded in place, to avoid copying the message twice.
+                        put<uint32_t>(entry_, 1 + sizeof(uint32_t) + record.message.size());
+                        encode(entry_, record.message);
+                    }
+                    binaryFile_.write(entry_.data(), entry_.size());
+                }
+
+                static boost::posix_time::ptime toLocalTime(std::chrono::system_clock::time_point time) {
+                    auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+                    auto utc = boost::posix_time::from_time_t(us / 1000000) + boost::posix_time::microseconds(us % 1000000);
+                    return boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local(utc);
+                }
+        };
+        constexpr std::chrono::milliseconds RecordWriter::pollInterval;
+
+        // First used after the sinks are constructed, so it stops before they are destroyed.
+        static RecordWriter & getRecordWriter() {
+            static RecordWriter writer;
+            return writer;
+        }
+
+        static ThreadQueue & getThreadQueue() {
+            // The queue is shared with the writer, which outlives the thread to empty it.
+            struct Holder {
+                std::shared_ptr<ThreadQueue> queue;
+                ~Holder() { if ( queue ) queue->abandoned.store(true, std::memory_order_release); }
+            };
+            static thread_local Holder holder;
+
+            if ( !holder.queue ) {
+                holder.queue = std::make_shared<ThreadQueue>();
+                getRecordWriter().add(holder.queue);
+            }
+            return *holder.queue;
+        }
 
         std::string folderize(const std::string & name) {
             if ( !name.empty() && name.back() != '/' ) return name + '/';
             return name;
         }
 
-        void init(const std::string & folder) {
+        void init(const std::string & folder, LogFormat format) {
             logFolder = folderize(folder);
             boost::filesystem::create_directory(logFolder);
 
+            logFormat = format;
+            if ( format == BinaryFormat )
+                getRecordWriter().setBinary(logFolder + "log.nlog");
+
             boost::shared_ptr< logging::core > core = logging::core::get();
 
             core->add_global_attribute("TimeStamp", attrs::local_clock());
 
+            getRecordWriter().start();
+            if ( format == BinaryFormat ) return;
+            if ( format == SharedFormat ) {
+                // A single sink without filter, so the cost of a message does not grow with the clients.
+                sharedSink = boost::make_shared< TextSink >();
+                sharedSink->locked_backend()->add_stream(boost::make_shared< std::ofstream >(logFolder + "log.txt"));
+                #if NAO_DEBUG
+                sharedSink->locked_backend()->auto_flush(true);
+                #endif
+                sharedSink->set_formatter
+                (
+                     expr::format("[%1%][%2%][%3%] %4%")
+                         % expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "%Y-%m-%d %H:%M:%S")
+                         % logging::trivial::severity
+                         % clientAttribute
+                         % expr::smessage
+                );
+                core->add_sink(sharedSink);
+                return;
+            }
+
             // We can avoid removing our sink because we're going to log during
             // the whole application anyway.
             makeSink("Log", "");
@@ -67,6 +364,9 @@ namespace NaoFramework {
         }
 
         bool makeSink(const std::string & client, const std::string & subfolder) {
+            // Shared and binary logs hold all clients, and are split offline.
+            if ( logFormat != TextFormat ) return true;
+
             bool result = false;
             std::string subfolderName = folderize(subfolder);
             boost::filesystem::create_directory(logFolder+subfolderName);
@@ -112,6 +412,8 @@ namespace NaoFramework {
 
         void removeSink(const std::string & client, const std::string & subfolder) {
             std::string clientName = folderize(subfolder) + client;
+            // Messages still queued for the sink must reach it first.
+            flush();
             availableSinksMutex.lock();
             auto it = availableSinks.find(clientName);
 
@@ -127,14 +429,41 @@ namespace NaoFramework {
             return; // ONLY EXIT POINT HERE! UNLOCK MUTEX!
         }
 
+        void setLevel(MessagePriority priority) {
+            minimumPriority.store(priority, std::memory_order_relaxed);
+        }
+
+        bool isEnabled(MessagePriority priority) {
+            return priority >= minimumPriority.load(std::memory_order_relaxed);
+        }
+
+        ChannelPointer makeChannel(const std::string & client, const std::string & subfolder) {
+            return std::make_shared<Channel>(folderize(subfolder) + client);
+        }
+
         void log(const std::string & client, const std::string & subfolder, const std::string & message, MessagePriority priority) {
-            using namespace logging::trivial;
-            std::string clientName = folderize(subfolder) + client;
-            // Maybe this can improved by giving the loggers to the Modules directly.
-            // Profiling first, though.
-            src::severity_logger< severity_level > slg;
-            slg.add_attribute("Client", attrs::constant< std::string >(clientName));
-            BOOST_LOG_SEV(slg, static_cast<severity_level>(priority)) << message;
+            if ( !isEnabled(priority) ) return;
+            log(makeChannel(client, subfolder), message, priority);
+        }
+
+        void log(const ChannelPointer & channel, const std::string & message, MessagePriority priority) {
+            if ( !channel || !isEnabled(priority) ) return;
+            auto & queue = getThreadQueue();
+            Record record{channel, message, priority, std::chrono::system_clock::now(), nullptr, ""};
+            if ( !queue.records.push(std::move(record)) )
+                queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void logEncoded(const ChannelPointer & channel, MessagePriority priority, const char * format, std::string && arguments) {
+            if ( !channel || !isEnabled(priority) ) return;
+            auto & queue = getThreadQueue();
+            Record record{channel, "", priority, std::chrono::system_clock::now(), format, std::move(arguments)};
+            if ( !queue.records.push(std::move(record)) )
+                queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void flush() {
+            getRecordWriter().flush();
         }
     }
 }
@@ -4,24 +4,27 @@
 
 namespace NaoFramework {
     namespace Log {
-        Loggable::Loggable(std::string name, std::string folder) : name_(name), folder_(folder) {
+        Loggable::Loggable(std::string name, std::string folder) : name_(name), folder_(folder), channel_(makeChannel(name_, folder_)) {
             makeSink(name_, folder_);
         }
         Loggable::~Loggable() {
             removeSink(name_, folder_);
         }
 
-        Loggable::Loggable(Loggable&& other) : name_(std::move(other.name_)), folder_(std::move(other.folder_)) {}
+        Loggable::Loggable(Loggable&& other) : name_(std::move(other.name_)), folder_(std::move(other.folder_)), channel_(std::move(other.channel_)) {}
 
         const Loggable& Loggable::operator=(Loggable&& other) {
             removeSink(name_, folder_);
 
             name_ = std::move(other.name_);
             folder_ = std::move(other.folder_);
+            channel_ = std::move(other.channel_);
+
+            return *this;
         }
 
         void Loggable::log(const std::string & message, MessagePriority priority) {
-            NaoFramework::Log::log(name_, folder_, message, priority);
+            NaoFramework::Log::log(channel_, message, priority);
         }
     }
 }
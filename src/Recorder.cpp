@@ -0,0 +1,127 @@
+#include <NaoFramework/Comm/Recorder.hpp>
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace NaoFramework {
+    namespace Comm {
+        // The file grows in steps of this size, to remap it rarely.
+        static constexpr size_t growth = 64 << 20;
+
+        Recorder::Recorder(const std::string & filename) : filename_(filename), fd_(-1), map_(nullptr), capacity_(0), size_(0),
+                                                           samples_(0), start_(std::chrono::steady_clock::now())
+        {
+            fd_ = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if ( fd_ < 0 ) return;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if ( !reserve(sizeof(Recording::Magic)) ) return;
+            write(Recording::Magic, sizeof(Recording::Magic));
+        }
+
+        Recorder::~Recorder() {
+            finish();
+        }
+
+        bool Recorder::isOpen() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return map_ != nullptr;
+        }
+
+        uint32_t Recorder::addKey(const std::string & blackboard, const std::string & key, const std::string & type,
+                                  const std::atomic<unsigned long> * cycles)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint32_t id = cycles_.size();
+            cycles_.push_back(cycles);
+
+            size_t size = 1 + sizeof(uint32_t) * 4 + blackboard.size() + key.size() + type.size();
+            if ( !reserve(size) ) return id;
+
+            uint8_t entry = Recording::KeyEntry;
+            write(&entry, sizeof(entry));
+            write(&id, sizeof(id));
+            for ( auto string : { &blackboard, &key, &type } ) {
+                uint32_t length = string->size();
+                write(&length, sizeof(length));
+                write(string->data(), length);
+            }
+            return id;
+        }
+
+        void Recorder::finish() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            release();
+        }
+
+        unsigned long Recorder::getSamples() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return samples_;
+        }
+
+        void Recorder::append(uint32_t id, const std::string & data) {
+            int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if ( id >= cycles_.size() ) return;
+            uint64_t cycle = cycles_[id] ? cycles_[id]->load(std::memory_order_acquire) : 0;
+            uint32_t length = data.size();
+
+            if ( !reserve(1 + sizeof(id) + sizeof(time) + sizeof(cycle) + sizeof(length) + length) ) return;
+
+            uint8_t entry = Recording::SampleEntry;
+            write(&entry, sizeof(entry));
+            write(&id, sizeof(id));
+            write(&time, sizeof(time));
+            write(&cycle, sizeof(cycle));
+            write(&length, sizeof(length));
+            write(data.data(), length);
+            ++samples_;
+        }
+
+        bool Recorder::reserve(size_t size) {
+            if ( fd_ < 0 ) return false;
+            if ( map_ && size_ + size <= capacity_ ) return true;
+
+            size_t capacity = capacity_ + growth;
+            while ( capacity < size_ + size ) capacity += growth;
+
+            // The step is allocated on disk rather than left sparse, so that a full disk fails
+            // here instead of raising SIGBUS when a provide writes into the mapping.
+            void * map = MAP_FAILED;
+            if ( !posix_fallocate(fd_, capacity_, capacity - capacity_) ) {
+                if ( map_ ) munmap(map_, capacity_);
+                map_ = nullptr;
+                map = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            }
+            if ( map == MAP_FAILED ) {
+                // We keep what was recorded so far, and ignore further samples.
+                release();
+                return false;
+            }
+
+            map_ = static_cast<char*>(map);
+            capacity_ = capacity;
+            return true;
+        }
+
+        void Recorder::release() {
+            if ( map_ ) munmap(map_, capacity_);
+            map_ = nullptr;
+            capacity_ = 0;
+            if ( fd_ >= 0 ) {
+                // The unused end of the last step is dropped.
+                if ( ftruncate(fd_, size_) ) {}
+                close(fd_);
+                fd_ = -1;
+            }
+        }
+
+        void Recorder::write(const void * data, size_t size) {
+            std::memcpy(map_ + size_, data, size);
+            size_ += size;
+        }
+    }
+}
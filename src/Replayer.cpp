@@ -0,0 +1,129 @@
+#include <NaoFramework/Comm/Replayer.hpp>
+#include <NaoFramework/Comm/Blackboard.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace NaoFramework {
+    namespace Comm {
+        template <class T>
+        static bool get(const char *& data, const char * end, T & value) {
+            return Serializer<T>::read(data, end, value);
+        }
+
+        Replayer::Replayer(const std::string & filename) : map_(nullptr), size_(0), next_(0), started_(false), offset_(0),
+                                                           finished_(false)
+        {
+            int fd = open(filename.c_str(), O_RDONLY);
+            if ( fd < 0 ) return;
+
+            struct stat status;
+            if ( fstat(fd, &status) == 0 && status.st_size > 0 ) {
+                void * map = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if ( map != MAP_FAILED ) {
+                    map_ = static_cast<char*>(map);
+                    size_ = status.st_size;
+                }
+            }
+            // The mapping keeps the file alive.
+            close(fd);
+
+            if ( map_ && !index() ) {
+                munmap(map_, size_);
+                map_ = nullptr;
+            }
+        }
+
+        Replayer::~Replayer() {
+            if ( map_ ) munmap(map_, size_);
+        }
+
+        bool Replayer::isOpen() const {
+            return map_ != nullptr;
+        }
+
+        unsigned Replayer::attach(Blackboard & blackboard, std::vector<std::string> & skipped) {
+            unsigned attached = 0;
+            for ( auto & key : keys_ ) {
+                if ( key.blackboard != blackboard.getName() ) continue;
+                key.slot = blackboard.registerReplay(key.name, key.type);
+                if ( key.slot ) ++attached;
+                else skipped.push_back(key.name);
+            }
+            // Samples of other keys are dropped, so that cycles are only counted on ours.
+            samples_.erase(std::remove_if(std::begin(samples_), std::end(samples_),
+                                          [this](const Sample & s){ return !keys_[s.key].slot; }),
+                           std::end(samples_));
+            std::stable_sort(std::begin(samples_), std::end(samples_),
+                             [](const Sample & a, const Sample & b){ return a.cycle < b.cycle; });
+            finished_.store(samples_.empty(), std::memory_order_relaxed);
+            return attached;
+        }
+
+        void Replayer::detach(Blackboard & blackboard) {
+            for ( auto & key : keys_ ) {
+                if ( !key.slot || key.blackboard != blackboard.getName() ) continue;
+                blackboard.releaseGlobalProvide(key.name);
+                key.slot = nullptr;
+            }
+            next_ = samples_.size();
+            finished_.store(true, std::memory_order_release);
+        }
+
+        void Replayer::provide(unsigned long cycle) {
+            if ( next_ == samples_.size() ) return;
+            if ( !started_ ) {
+                started_ = true;
+                // Unsigned, as the wave may be ahead of the recording, but it wraps back when added.
+                offset_ = samples_[next_].cycle - cycle;
+            }
+            // Cycles without samples are replayed as cycles without new data.
+            uint64_t target = cycle + offset_;
+            while ( next_ < samples_.size() && samples_[next_].cycle <= target ) {
+                auto & sample = samples_[next_++];
+                keys_[sample.key].slot->writeSerialized(sample.data, sample.size);
+            }
+            if ( next_ == samples_.size() ) finished_.store(true, std::memory_order_release);
+        }
+
+        bool Replayer::isFinished() const {
+            return finished_.load(std::memory_order_acquire);
+        }
+
+        bool Replayer::index() {
+            const char * data = map_;
+            const char * end  = map_ + size_;
+            if ( size_ < sizeof(Recording::Magic) || std::memcmp(data, Recording::Magic, sizeof(Recording::Magic)) ) return false;
+            data += sizeof(Recording::Magic);
+
+            // A recording cut short by a crash ends with a partial entry, or with the zeroes
+            // of its last growth step, so we keep the samples before it.
+            uint8_t entry;
+            while ( get(data, end, entry) ) {
+                if ( entry == Recording::KeyEntry ) {
+                    uint32_t id;
+                    Key key{"", "", "", nullptr};
+                    if ( !get(data, end, id) || id != keys_.size() ||
+                         !get(data, end, key.blackboard) || !get(data, end, key.name) || !get(data, end, key.type) ) break;
+                    keys_.push_back(std::move(key));
+                }
+                else if ( entry == Recording::SampleEntry ) {
+                    Sample sample;
+                    int64_t time;
+                    if ( !get(data, end, sample.key) || !get(data, end, time) || !get(data, end, sample.cycle) ||
+                         !get(data, end, sample.size) || sample.key >= keys_.size() ||
+                         static_cast<size_t>(end - data) < sample.size ) break;
+                    sample.data = data;
+                    data += sample.size;
+                    samples_.push_back(sample);
+                }
+                else break;
+            }
+            return true;
+        }
+    }
+}
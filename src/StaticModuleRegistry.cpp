@@ -0,0 +1,44 @@
+#include <NaoFramework/Modules/StaticModuleRegistry.hpp>
+
+#include <stdexcept>
+
+namespace NaoFramework {
+    namespace Modules {
+        StaticModuleRegistry & StaticModuleRegistry::get() {
+            static StaticModuleRegistry registry;
+            return registry;
+        }
+
+        bool StaticModuleRegistry::add(const std::string & name, staticModuleFactory * factory) {
+            return factories_.emplace(name, factory).second;
+        }
+
+        bool StaticModuleRegistry::contains(const std::string & name) const {
+            return factories_.find(name) != std::end(factories_);
+        }
+
+        std::unique_ptr<ModuleInterface> StaticModuleRegistry::make(const std::string & name,
+                                                                    Comm::LocalBlackboardAdapter & comm,
+                                                                    Comm::ExternalBlackboardAdapterMap & others) const
+        {
+            auto it = factories_.find(name);
+            if ( it == std::end(factories_) ) throw std::runtime_error("no static module called " + name);
+
+            // Modules report errors in their constructors by throwing either exceptions or
+            // registration errors, and we want a message either way.
+            try {
+                return std::unique_ptr<ModuleInterface>(it->second(comm, others));
+            } catch ( std::exception & e ) {
+                throw std::runtime_error(e.what());
+            } catch ( ... ) {
+                throw std::runtime_error("the module constructor failed");
+            }
+        }
+
+        std::vector<std::string> StaticModuleRegistry::getNames() const {
+            std::vector<std::string> names;
+            for ( auto & pair : factories_ ) names.push_back(pair.first);
+            return names;
+        }
+    }
+}
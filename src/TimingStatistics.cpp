@@ -0,0 +1,84 @@
+#include <NaoFramework/Core/TimingStatistics.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace NaoFramework {
+    namespace Core {
+        constexpr unsigned TimingStatistics::SubBuckets;
+        constexpr unsigned TimingStatistics::MaxExponent;
+        constexpr unsigned TimingStatistics::BucketsNumber;
+
+        TimingStatistics::TimingStatistics() {
+            reset();
+        }
+
+        void TimingStatistics::record(Duration d) {
+            uint64_t value = d.count() > 0 ? d.count() : 0;
+            auto & bucket = buckets_[getBucket(value)];
+
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            if ( value < min_.load(std::memory_order_relaxed) ) min_.store(value, std::memory_order_relaxed);
+            if ( value > max_.load(std::memory_order_relaxed) ) max_.store(value, std::memory_order_relaxed);
+            // Count last, so readers don't see counts without their data.
+            count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        TimingStatistics::Summary TimingStatistics::summarize() const {
+            Summary s;
+            s.count = count_.load(std::memory_order_acquire);
+            if ( s.count == 0 ) {
+                s.min = s.mean = s.max = s.p50 = s.p90 = s.p99 = Duration(0);
+                return s;
+            }
+            s.min   = Duration(min_.load(std::memory_order_relaxed));
+            s.max   = Duration(max_.load(std::memory_order_relaxed));
+            s.mean  = Duration(sum_.load(std::memory_order_relaxed) / s.count);
+            s.p50   = std::min(std::max(getPercentile(s.count, 0.50), s.min), s.max);
+            s.p90   = std::min(std::max(getPercentile(s.count, 0.90), s.min), s.max);
+            s.p99   = std::min(std::max(getPercentile(s.count, 0.99), s.min), s.max);
+
+            return s;
+        }
+
+        void TimingStatistics::reset() {
+            count_.store(0, std::memory_order_relaxed);
+            sum_.store(0, std::memory_order_relaxed);
+            min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+            for ( auto & bucket : buckets_ ) bucket.store(0, std::memory_order_relaxed);
+        }
+
+        unsigned TimingStatistics::getBucket(uint64_t value) {
+            if ( value < 8 ) return value;
+
+            unsigned exponent = 63 - __builtin_clzll(value);
+            if ( exponent >= MaxExponent ) return BucketsNumber - 1;
+
+            unsigned sub = (value >> (exponent - 2)) & (SubBuckets - 1);
+            return 8 + (exponent - 3) * SubBuckets + sub;
+        }
+
+        uint64_t TimingStatistics::getBucketValue(unsigned bucket) {
+            if ( bucket < 8 ) return bucket;
+
+            unsigned exponent = (bucket - 8) / SubBuckets + 3;
+            unsigned sub      = (bucket - 8) % SubBuckets;
+            uint64_t width    = uint64_t(1) << (exponent - 2);
+            // We return the middle of the bucket.
+            return (SubBuckets + sub) * width + width / 2;
+        }
+
+        TimingStatistics::Duration TimingStatistics::getPercentile(uint64_t count, double percentile) const {
+            uint64_t target = static_cast<uint64_t>(std::ceil(count * percentile));
+            uint64_t seen = 0;
+            for ( unsigned i = 0; i < BucketsNumber; ++i ) {
+                seen += buckets_[i].load(std::memory_order_relaxed);
+                if ( seen >= target ) return Duration(getBucketValue(i));
+            }
+            return Duration(getBucketValue(BucketsNumber - 1));
+        }
+    }
+}
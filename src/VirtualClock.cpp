@@ -0,0 +1,33 @@
+#include <NaoFramework/Core/VirtualClock.hpp>
+
+namespace NaoFramework {
+    namespace Core {
+        std::atomic<bool> VirtualClock::simulated_(false);
+        std::atomic<VirtualClock::rep> VirtualClock::now_(0);
+
+        VirtualClock::time_point VirtualClock::now() {
+            if ( simulated_.load(std::memory_order_acquire) )
+                return time_point(duration(now_.load(std::memory_order_acquire)));
+
+            auto steady = std::chrono::steady_clock::now().time_since_epoch();
+            return time_point(std::chrono::duration_cast<duration>(steady));
+        }
+
+        bool VirtualClock::isSimulated() {
+            return simulated_.load(std::memory_order_acquire);
+        }
+
+        void VirtualClock::startSimulation() {
+            now_.store(0, std::memory_order_release);
+            simulated_.store(true, std::memory_order_release);
+        }
+
+        void VirtualClock::advance(time_point time) {
+            now_.store(time.time_since_epoch().count(), std::memory_order_release);
+        }
+
+        void VirtualClock::stopSimulation() {
+            simulated_.store(false, std::memory_order_release);
+        }
+    }
+}
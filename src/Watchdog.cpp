@@ -0,0 +1,80 @@
+#include <NaoFramework/Core/Watchdog.hpp>
+
+#include <NaoFramework/Core/BrainWave.hpp>
+
+#include <algorithm>
+
+namespace NaoFramework {
+    namespace Core {
+        // Checks are never closer than this, so that tiny deadlines do not keep a core busy.
+        static const std::chrono::microseconds minimumInterval(100);
+
+        Watchdog::Watchdog() : Loggable("Watchdog", "Core"), quitting_(false),
+                               thread_(&Watchdog::run, this) {}
+
+        Watchdog::~Watchdog() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                quitting_ = true;
+            }
+            condition_.notify_all();
+            thread_.join();
+        }
+
+        void Watchdog::watch(const BrainWave & wave) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto found = std::find_if(std::begin(waves_), std::end(waves_),
+                                          [&wave](const Watched & w){ return w.wave == &wave; });
+                if ( found == std::end(waves_) ) {
+                    log( "Watching wave " + wave.getName() );
+                    waves_.push_back({&wave, 0});
+                }
+            }
+            // The deadline may have changed, so the thread computes its interval again.
+            condition_.notify_all();
+        }
+
+        void Watchdog::run() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while ( !quitting_ ) {
+                auto interval = getInterval();
+                // Without deadlines there is nothing to check until a wave is watched again.
+                if ( interval.count() == 0 ) condition_.wait(lock);
+                else if ( condition_.wait_for(lock, interval) == std::cv_status::timeout ) {
+                    for ( auto & watched : waves_ )
+                        check(watched);
+                }
+            }
+        }
+
+        std::chrono::microseconds Watchdog::getInterval() const {
+            std::chrono::microseconds shortest(0);
+            for ( auto & watched : waves_ ) {
+                auto deadline = watched.wave->getDeadline();
+                if ( deadline.count() && ( !shortest.count() || deadline < shortest ) ) shortest = deadline;
+            }
+            if ( !shortest.count() ) return shortest;
+            return std::max(shortest / 2, minimumInterval);
+        }
+
+        void Watchdog::check(Watched & watched) {
+            auto & wave = *watched.wave;
+            auto deadline = wave.getDeadline();
+            if ( deadline.count() == 0 ) return;
+
+            auto heartbeat = wave.getHeartbeat();
+            if ( !heartbeat.inCycle || heartbeat.cycles == watched.reported ) return;
+
+            auto late = std::chrono::steady_clock::now() - heartbeat.start - deadline;
+            if ( late.count() <= 0 ) return;
+
+            watched.reported = heartbeat.cycles;
+            log( "Wave " + wave.getName() + " is " +
+                 std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(late).count()) +
+                 " ms past its deadline in cycle " + std::to_string(heartbeat.cycles) +
+                 ", still running module " + (heartbeat.module.empty() ? "(unknown)" : heartbeat.module) + ".",
+                 Log::Warning );
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#include <NaoFramework/Core/WorkerPool.hpp>
+
+namespace NaoFramework {
+    namespace Core {
+        WorkerPool::WorkerPool(unsigned workers, const std::function<void()> & setup) :
+                                                   batch_(0), quitting_(false), active_(0),
+                                                   task_(nullptr), count_(0), next_(0)
+        {
+            for ( unsigned i = 0; i < workers; ++i )
+                workers_.emplace_back([this, setup](){
+                    if ( setup ) setup();
+                    work();
+                });
+        }
+
+        WorkerPool::~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                quitting_ = true;
+            }
+            start_.notify_all();
+            for ( auto & worker : workers_ ) worker.join();
+        }
+
+        void WorkerPool::run(size_t count, const Task & task) {
+            if ( count == 0 ) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                task_   = &task;
+                count_  = count;
+                next_.store(0, std::memory_order_relaxed);
+                active_ = workers_.size();
+                ++batch_;
+            }
+            start_.notify_all();
+
+            // We help too, rather than just waiting.
+            runTasks();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this](){ return active_ == 0; });
+            task_ = nullptr;
+        }
+
+        unsigned WorkerPool::getWorkers() const {
+            return workers_.size();
+        }
+
+        void WorkerPool::work() {
+            unsigned long seen = 0;
+            while ( true ) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    start_.wait(lock, [this, seen](){ return quitting_ || batch_ != seen; });
+                    if ( quitting_ ) return;
+                    seen = batch_;
+                }
+                runTasks();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if ( --active_ != 0 ) continue;
+                }
+                done_.notify_one();
+            }
+        }
+
+        void WorkerPool::runTasks() {
+            size_t i;
+            while ( (i = next_.fetch_add(1, std::memory_order_relaxed)) < count_ )
+                (*task_)(i);
+        }
+    }
+}
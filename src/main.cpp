@@ -10,12 +10,15 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstdlib>
 
 using std::cout;
 
 int main(int argc, const char * argv[]) {
     // Must call this!
-    NaoFramework::Log::init();
+    NaoFramework::Log::init("log", std::getenv("NAO_BINARY_LOG") ? NaoFramework::Log::BinaryFormat :
+                                   std::getenv("NAO_SHARED_LOG") ? NaoFramework::Log::SharedFormat :
+                                                                   NaoFramework::Log::TextFormat);
 
     namespace pl = std::placeholders;
     using namespace NaoFramework::Console;
@@ -26,8 +29,32 @@ int main(int argc, const char * argv[]) {
 
     Brain brain;
     c.registerCommand("add",    std::bind(&Brain::addDynamicModule,     &brain, pl::_1));
+    c.registerCommand("reload", std::bind(&Brain::reloadDynamicModule,  &brain, pl::_1));
+    c.registerCommand("load",   std::bind(&Brain::loadDynamicModules,   &brain, pl::_1));
+    c.registerCommand("startup",std::bind(&Brain::printStartup,         &brain, pl::_1));
     c.registerCommand("create", std::bind(&Brain::createWave,           &brain, pl::_1));
     c.registerCommand("test",   std::bind(&Brain::execute,              &brain, pl::_1));
+    c.registerCommand("period", std::bind(&Brain::setWavePeriod,        &brain, pl::_1));
+    c.registerCommand("trigger",std::bind(&Brain::setWaveTrigger,       &brain, pl::_1));
+    c.registerCommand("stats",  std::bind(&Brain::printStatistics,      &brain, pl::_1));
+    c.registerCommand("parallel",std::bind(&Brain::setWaveParallel,     &brain, pl::_1));
+    c.registerCommand("executor",std::bind(&Brain::setWaveExecutor,     &brain, pl::_1));
+    c.registerCommand("sched",  std::bind(&Brain::setWaveScheduling,    &brain, pl::_1));
+    c.registerCommand("memlock",std::bind(&Brain::lockMemory,           &brain, pl::_1));
+    c.registerCommand("deadline",std::bind(&Brain::setWaveDeadline,     &brain, pl::_1));
+    c.registerCommand("record", std::bind(&Brain::recordKeys,           &brain, pl::_1));
+    c.registerCommand("replay", std::bind(&Brain::replayRecording,      &brain, pl::_1));
+    c.registerCommand("simulate",std::bind(&Brain::simulate,            &brain, pl::_1));
+    c.registerCommand("loglevel",[](std::vector<std::string> & inputs) -> unsigned {
+        using namespace NaoFramework::Log;
+        for ( int p = Trace; inputs.size() == 2 && p <= Fatal; ++p )
+            if ( inputs[1] == BinaryLog::getPriorityName(static_cast<MessagePriority>(p)) ) {
+                setLevel(static_cast<MessagePriority>(p));
+                return 0;
+            }
+        cout << "Usage: " << inputs[0] << " trace|debug|info|warning|error|fatal\n";
+        return 1;
+    });
 
     cout << "\nWelcome to the NaoFramework command line interface!\n";
     // Default running script